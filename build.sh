@@ -1,7 +1,8 @@
 #!/bin/bash
 
 # LED Cube Matrix Build Script
-# This script builds either GPIO mode (for Raspberry Pi) or OpenGL mode (for desktop)
+# This script builds GPIO mode (for Raspberry Pi), OpenGL mode (for desktop)
+# or headless mode (no display, no GPIO)
 
 set -e
 
@@ -90,6 +91,8 @@ build() {
     # Configure with CMake
     if [ "$mode" = "gpio" ]; then
         cmake .. -DBUILD_GPIO_MODE=ON -DBUILD_OPENGL_MODE=OFF
+    elif [ "$mode" = "headless" ]; then
+        cmake .. -DBUILD_HEADLESS_MODE=ON -DBUILD_GPIO_MODE=OFF -DBUILD_OPENGL_MODE=OFF
     else
         cmake .. -DBUILD_GPIO_MODE=OFF -DBUILD_OPENGL_MODE=ON
     fi
@@ -128,8 +131,14 @@ main() {
                 MODE="opengl"
                 shift
                 ;;
+            --headless)
+                MODE="headless"
+                shift
+                ;;
             --install-deps)
-                if [ "$MODE" = "gpio" ]; then
+                if [ "$MODE" = "headless" ]; then
+                    print_status "Headless mode only needs cmake and a C++17 compiler"
+                elif [ "$MODE" = "gpio" ]; then
                     install_gpio_deps
                 else
                     install_opengl_deps
@@ -142,6 +151,7 @@ main() {
                 echo "Options:"
                 echo "  --gpio          Build in GPIO mode (for Raspberry Pi)"
                 echo "  --opengl        Build in OpenGL mode (for desktop)"
+                echo "  --headless      Build in headless mode (no display, no GPIO)"
                 echo "  --install-deps  Install dependencies for current mode"
                 echo "  --help, -h      Show this help message"
                 echo ""
@@ -168,6 +178,9 @@ main() {
     if [ "$MODE" = "gpio" ]; then
         print_status "Building GPIO mode for Raspberry Pi..."
         build "gpio"
+    elif [ "$MODE" = "headless" ]; then
+        print_status "Building headless mode..."
+        build "headless"
     else
         print_status "Building OpenGL mode for desktop..."
         build "opengl"
@@ -1,12 +1,17 @@
 #pragma once
 
 #include "LEDCube.h"
+#include "CubeTopology.h"
+#include "ParticleSystem.h"
+#include <array>
 #include <functional>
 #include <string>
 #include <memory>
 
 namespace LEDCube {
 
+class JobSystem;
+
 // Animation interface
 class Animation {
 public:
@@ -79,13 +84,9 @@ public:
     void setGravityDirection(float pitch, float yaw);
 
 private:
-    struct RainDrop {
-        Position pos;
-        double speed;
-        Color color;
-    };
+    static constexpr size_t MAX_DROPS = 4096;
     
-    std::vector<RainDrop> drops;
+    ParticleSystem drops;
     double spawnTimer = 0.0;
     
     // Gravity direction (normalized vector)
@@ -94,41 +95,80 @@ private:
     float gravityZ = 0.0f;
 };
 
-class WaveAnimation : public Animation {
+// Inputs of one pixel for PixelShaderAnimation::shade
+struct PixelInput {
+    int face;
+    int x, y;                           // Pixel on the face
+    float u, v;                         // Pixel centre on the face, 0..1
+    CubeTopology::SurfacePoint position; // Pixel centre in space, -1..1
+    double time;                        // Animation time (scaled by speed)
+};
+
+// Animation defined by a pure function of each surface pixel. The surface
+// is split into row blocks that are shaded in parallel on a JobSystem and
+// written straight into the cube's rows, so shade() must not modify the
+// animation; per-frame constants belong in prepare().
+class PixelShaderAnimation : public Animation {
 public:
-    WaveAnimation();
-    
     void init() override;
     void update(double deltaTime) override;
     void render(LEDCube& cube) override;
     void reset() override;
     
-    std::string getName() const override { return "Wave"; }
     bool isFinished() const override { return false; }
     double getDuration() const override { return 0.0; }
+    
+    // Job system the pixels are shaded on; nullptr uses JobSystem::shared()
+    void setJobSystem(JobSystem* system) { jobSystem = system; }
+
+protected:
+    // Called on the rendering thread before each frame is shaded
+    virtual void prepare(double time) { (void)time; }
+    virtual Color shade(const PixelInput& pixel) const = 0;
+
+private:
+    static constexpr int ROWS_PER_TILE = 16;
+    static constexpr int TILES_PER_FACE = CUBE_SIZE / ROWS_PER_TILE;
+    static constexpr int TILE_COUNT = TILES_PER_FACE * CUBE_DEPTH;
+    
+    // Row masks a tile reports for LEDCube::commitRows
+    struct TileRows {
+        uint64_t changed;
+        uint64_t lit;
+    };
+    
+    std::array<TileRows, TILE_COUNT> tileRows{};
+    JobSystem* jobSystem = nullptr;
+    
+    void shadeTile(LEDCube& cube, int tile);
+};
+
+class WaveAnimation : public PixelShaderAnimation {
+public:
+    WaveAnimation();
+    
+    std::string getName() const override { return "Wave"; }
+
+protected:
+    Color shade(const PixelInput& pixel) const override;
 
 private:
-    double waveTime = 0.0;
     Color waveColor = Color::Cyan();
 };
 
-class CubeRotationAnimation : public Animation {
+class CubeRotationAnimation : public PixelShaderAnimation {
 public:
     CubeRotationAnimation();
     
-    void init() override;
-    void update(double deltaTime) override;
-    void render(LEDCube& cube) override;
-    void reset() override;
-    
     std::string getName() const override { return "Cube Rotation"; }
-    bool isFinished() const override { return false; }
-    double getDuration() const override { return 0.0; }
+
+protected:
+    void prepare(double time) override;
+    Color shade(const PixelInput& pixel) const override;
 
 private:
-    double rotationX = 0.0;
-    double rotationY = 0.0;
-    double rotationZ = 0.0;
+    // Row-major rotation for the current frame
+    std::array<float, 9> rotation{};
 };
 
 class GameOfLifeAnimation : public Animation {
@@ -143,11 +183,33 @@ public:
     std::string getName() const override { return "Game of Life"; }
     bool isFinished() const override { return false; }
     double getDuration() const override { return 0.0; }
+    
+    // Seconds between generations (0 = one generation per update)
+    void setUpdateInterval(double interval) { updateInterval = interval; }
+    double getUpdateInterval() const { return updateInterval; }
+    
+    // Advance the simulation by one generation
+    void step() { updateGameOfLife(); }
 
 private:
-    // 2D grid for the unfolded cube (64x384)
-    std::vector<std::vector<bool>> currentGrid;
-    std::vector<std::vector<bool>> nextGrid;
+    // Cells live on the cube surface: one 64-bit word per face row, bit x
+    // holds the cell at column x, faces stacked in face-major order
+    static constexpr int GRID_WIDTH = CUBE_SIZE;
+    static constexpr int GRID_HEIGHT = CUBE_SIZE * CUBE_DEPTH;
+    
+    // The cells around one face, taken from its neighbours across the seams
+    // (CubeTopology) before each generation. Column entries run from row -1
+    // to row 64; the corner entries stay dead.
+    struct FaceHalo {
+        uint64_t above = 0;
+        uint64_t below = 0;
+        std::array<uint8_t, CUBE_SIZE + 2> left{};
+        std::array<uint8_t, CUBE_SIZE + 2> right{};
+    };
+    
+    std::vector<uint64_t> currentGrid;
+    std::vector<uint64_t> nextGrid;
+    std::array<FaceHalo, CUBE_DEPTH> halos;
     
     // Game of Life parameters
     double updateTimer = 0.0;
@@ -156,7 +218,8 @@ private:
     // Helper methods
     void initializeRandom();
     void updateGameOfLife();
-    int countNeighbors(int x, int y);
+    void gatherHalos();
+    static uint64_t nextRow(uint64_t above, uint64_t row, uint64_t below, unsigned left, unsigned right);
     bool getCell(int x, int y);
     void setCell(int x, int y, bool alive);
 };
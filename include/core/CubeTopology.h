@@ -0,0 +1,109 @@
+#pragma once
+
+#include "LEDCube.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace LEDCube {
+
+// Adjacency of the cube's outer surface. Faces are oriented as in the
+// OpenGL preview (0 front, 1 back, 2 left, 3 right, 4 top, 5 bottom, with
+// x along the texture's u and y along its v), and pixels are addressed by
+// face-major index (LEDCube::positionToIndex).
+//
+// A step off a face edge continues on the face across the seam, in that
+// face's own coordinates, so stencils see the surface as one continuous
+// sheet. At the eight cube corners three faces meet and the diagonal step
+// leads nowhere; those neighbours are NO_NEIGHBOR, an index one past the
+// last pixel, so kernels gathering from a TOTAL_LEDS + 1 array with a
+// zero at the end need no branch for them.
+//
+// The tables, and each pixel's position in space, are built once and
+// shared (instance()).
+class CubeTopology {
+public:
+    static constexpr int FACE_PIXELS = CUBE_SIZE * CUBE_SIZE;
+    static constexpr uint16_t NO_NEIGHBOR = TOTAL_LEDS;
+
+    // Neighbour order within a pixel's entry: 4-neighbours are -x, +x, -y,
+    // +y; 8-neighbours are the 3x3 block without its centre, row by row
+    static constexpr int NEIGHBORS_4 = 4;
+    static constexpr int NEIGHBORS_8 = 8;
+    static constexpr std::array<std::array<int, 2>, NEIGHBORS_4> OFFSETS_4 = {{{-1, 0}, {1, 0}, {0, -1}, {0, 1}}};
+    static constexpr std::array<std::array<int, 2>, NEIGHBORS_8> OFFSETS_8 = {
+        {{-1, -1}, {0, -1}, {1, -1}, {-1, 0}, {1, 0}, {-1, 1}, {0, 1}, {1, 1}}};
+
+    // A face padded by one pixel on every side, row-major; face pixel
+    // (x, y) is at (y + 1) * HALO_SIZE + x + 1
+    static constexpr int HALO_SIZE = CUBE_SIZE + 2;
+    static constexpr int HALO_CELLS = HALO_SIZE * HALO_SIZE;
+
+    // Centre of a surface pixel, with the cube spanning -1..1 on each axis
+    // (x right, y up, z towards the front face)
+    struct SurfacePoint {
+        float x, y, z;
+    };
+
+    // One padding cell of a halo and the surface pixel it mirrors
+    struct HaloCell {
+        uint16_t offset; // Into the halo buffer
+        uint16_t source; // Face-major surface index
+    };
+
+    static const CubeTopology& instance();
+
+    // Surface index of face coordinates up to one pixel beyond the face
+    // (-1..CUBE_SIZE), following seams; NO_NEIGHBOR at the cube corners
+    static int resolve(int face, int x, int y);
+
+    // NEIGHBORS_4 / NEIGHBORS_8 consecutive indices per surface pixel
+    const uint16_t* getNeighbors4() const { return neighbors4.data(); }
+    const uint16_t* getNeighbors8() const { return neighbors8.data(); }
+    const uint16_t* getNeighbors4(int index) const { return neighbors4.data() + index * NEIGHBORS_4; }
+    const uint16_t* getNeighbors8(int index) const { return neighbors8.data() + index * NEIGHBORS_8; }
+
+    const SurfacePoint& getPosition(int index) const { return positions[index]; }
+
+    // The padding cells of a face's halo that lie on the surface: rows -1
+    // and CUBE_SIZE by x, then columns -1 and CUBE_SIZE by y, CUBE_SIZE
+    // cells each. The halo corners are always cube corners and have no source.
+    const std::array<HaloCell, 4 * CUBE_SIZE>& getHaloBorder(int face) const { return haloBorders[face]; }
+
+    // Copies a face and the ring of pixels around it from a face-major
+    // surface of TOTAL_LEDS values into a HALO_CELLS buffer; the halo
+    // corners get outside
+    template <typename T>
+    void fillHalo(const T* surface, int face, T* halo, const T& outside = T()) const {
+        const T* source = surface + face * FACE_PIXELS;
+        for (int y = 0; y < CUBE_SIZE; ++y) {
+            std::copy(source + y * CUBE_SIZE, source + (y + 1) * CUBE_SIZE, halo + (y + 1) * HALO_SIZE + 1);
+        }
+        for (const HaloCell& cell : haloBorders[face]) {
+            halo[cell.offset] = surface[cell.source];
+        }
+        halo[0] = outside;
+        halo[HALO_SIZE - 1] = outside;
+        halo[HALO_CELLS - HALO_SIZE] = outside;
+        halo[HALO_CELLS - 1] = outside;
+    }
+
+    // All six faces, into CUBE_DEPTH consecutive halos
+    template <typename T>
+    void fillHalos(const T* surface, T* halos, const T& outside = T()) const {
+        for (int face = 0; face < CUBE_DEPTH; ++face) {
+            fillHalo(surface, face, halos + face * HALO_CELLS, outside);
+        }
+    }
+
+private:
+    CubeTopology();
+
+    std::vector<uint16_t> neighbors4;
+    std::vector<uint16_t> neighbors8;
+    std::vector<SurfacePoint> positions;
+    std::array<std::array<HaloCell, 4 * CUBE_SIZE>, CUBE_DEPTH> haloBorders;
+};
+
+} // namespace LEDCube
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Realtime.h"
+#include <chrono>
+#include <cstdint>
+
+namespace LEDCube {
+
+struct FramePacerOptions {
+    double targetRate = 60.0; // Frames per second; 0 = unpaced, frames are only counted
+    // Busy-wait this long before each deadline instead of trusting the
+    // scheduler's wake-up
+    std::chrono::nanoseconds spinWindow = std::chrono::microseconds(500);
+};
+
+struct FramePacerStats {
+    uint64_t frames = 0;          // Frames presented
+    uint64_t deadlines = 0;       // Deadlines waited for; 0 when unpaced
+    uint64_t missedDeadlines = 0; // Frames whose work ran past their deadline
+    uint64_t skippedFrames = 0;   // Deadlines dropped after falling a whole period behind
+    double achievedRate = 0.0;    // Frames presented per second since start
+    double wakeP99Us = 0.0;       // Lateness of the wake-up at met deadlines
+    double wakeMaxUs = 0.0;
+};
+
+// Paces a loop to absolute deadlines on a fixed grid (start + n * period),
+// so the time spent on a frame's work comes out of its period instead of
+// adding to it, and rounding never accumulates into drift.
+//
+// A frame that ends past its deadline starts the next one at once, catching
+// up on the following frames. One that falls a whole period or more behind
+// drops the deadlines it missed and carries on from the next one on the
+// grid, rather than running a burst of frames to catch up.
+//
+// Used by the thread it paces.
+class FramePacer {
+public:
+    explicit FramePacer(const FramePacerOptions& options = FramePacerOptions());
+
+    // Starts the schedule now; the first deadline is one period away
+    void start();
+
+    // Counts a frame actually shown; loop iterations that had nothing to
+    // show do not count towards the achieved rate
+    void framePresented() { ++frames; }
+
+    // Ends a frame: waits for its deadline (sleeping, then spinning for the
+    // last spinWindow) and returns the number of frames skipped, 0 when on
+    // time. Returns at once when unpaced.
+    int waitForNextFrame();
+
+    const FramePacerOptions& getOptions() const { return options; }
+    FramePacerStats getStats() const;
+
+private:
+    FramePacerOptions options;
+    std::chrono::steady_clock::duration period;
+    std::chrono::steady_clock::time_point startTime;
+    std::chrono::steady_clock::time_point deadline; // End of the current frame
+
+    uint64_t frames;
+    uint64_t deadlines;
+    uint64_t missedDeadlines;
+    uint64_t skippedFrames;
+    JitterMonitor wakeLateness;
+};
+
+} // namespace LEDCube
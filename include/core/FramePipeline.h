@@ -0,0 +1,116 @@
+#pragma once
+
+#include "LEDCube.h"
+#include "FrameProfiler.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace LEDCube {
+
+struct FramePipelineOptions {
+    int depth = 1;             // Frames produced ahead of the one being presented; 0 produces on demand
+    double frameRate = 60.0;   // Expected presentation rate; sets the first frame's simulation step
+    double maxDeltaTime = 0.1; // Longest simulation step, so a stall does not make animations jump
+};
+
+struct FramePipelineStats {
+    uint64_t framesProduced = 0;
+    uint64_t framesPresented = 0;
+    uint64_t stalls = 0;       // acquireFrame calls that found no frame ready
+    double latencyP50Ms = 0.0; // Input sampled to frame presented
+    double latencyP99Ms = 0.0;
+    double latencyMaxMs = 0.0;
+    double produceAvgMs = 0.0; // Commands, update and render per frame
+};
+
+// Produces frames on a thread of its own, depth frames ahead of
+// presentation, so a slow frame delays nothing as long as the average
+// keeps up; each frame of depth adds one frame of latency.
+//
+// The producer callback advances the simulation and draws into the cube it
+// is given. The step is the time since the previous frame's input; a new
+// frame is started each time one is presented, so the step follows the
+// presentation rate. Anything else that touches the animations (switching them,
+// applying input) must be posted so it runs on the producing thread
+// between frames; a frame's input time is when it starts, after its
+// commands.
+//
+// The consumer takes frames in order with acquireFrame, presents them and
+// hands them back with releaseFrame. A frame's dirty rows are relative to
+// the frame before it, as if it had been rendered in place.
+class FramePipeline {
+public:
+    using Producer = std::function<void(LEDCube& cube, double deltaTime)>;
+
+    explicit FramePipeline(Producer producer, const FramePipelineOptions& options = FramePipelineOptions());
+    ~FramePipeline();
+
+    FramePipeline(const FramePipeline&) = delete;
+    FramePipeline& operator=(const FramePipeline&) = delete;
+
+    void start();
+    void stop();
+    const FramePipelineOptions& getOptions() const { return options; }
+
+    // Runs command on the producing thread before the next frame
+    void post(std::function<void()> command);
+
+    // Next frame, waiting at most timeout for one; nullptr if none is ready
+    // (the previous frame stays on display). With depth 0 the frame is
+    // produced by the call that acquires it.
+    const LEDCube* acquireFrame(std::chrono::nanoseconds timeout = std::chrono::nanoseconds(0));
+    // After the acquired frame has been presented; acquiring again first
+    // returns the same frame
+    void releaseFrame();
+
+    FramePipelineStats getStats() const;
+
+private:
+    struct Slot {
+        LEDCube cube;
+        DirtyMasks staleRows{}; // Rows changed since this slot was last filled
+        std::chrono::steady_clock::time_point inputTime;
+    };
+
+    Producer producer;
+    FramePipelineOptions options;
+
+    // Owned by the producing thread; frames are drawn here and copied out
+    LEDCube working;
+    std::chrono::steady_clock::time_point workingInputTime;
+
+    // depth + 1 slots: queued frames and the one being presented
+    std::vector<std::unique_ptr<Slot>> slots;
+    size_t readIndex;
+    size_t writeIndex;
+    size_t readyCount;
+    bool consumerHolds;
+    bool stopping;
+    std::vector<std::function<void()>> commands;
+
+    std::thread thread;
+    mutable std::mutex mutex;
+    std::condition_variable frameReady;
+    std::condition_variable slotFree;
+
+    // Statistics; latency is written by the consumer only
+    std::atomic<uint64_t> framesProduced;
+    std::atomic<uint64_t> framesPresented;
+    std::atomic<uint64_t> stalls;
+    std::atomic<uint64_t> produceNs;
+    std::atomic<uint64_t> latencyMaxNs;
+    LatencyHistogram latency;
+
+    void produceLoop();
+    void produce();
+    void recordPresented(std::chrono::steady_clock::time_point inputTime);
+};
+
+} // namespace LEDCube
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace LEDCube {
+
+// Stages of a frame's budget
+enum class FrameStage {
+    Update,     // Animation simulation
+    Render,     // Animation drawing into the cube
+    Convert,    // Buffer conversion / hardware encoding
+    Upload,     // Texture upload
+    ScanOut,    // GPIO scan-out (per row pair)
+    Present,    // Buffer swap / frame handoff
+    Sleep,      // Frame pacing
+    Count
+};
+
+const char* frameStageName(FrameStage stage);
+
+// Log-linear latency histogram in nanoseconds (16 sub-buckets per power of
+// two, ~6% resolution, up to ~1100 s). Written by a single thread with plain
+// relaxed stores; any thread may read it.
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BUCKET_BITS = 4;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr int MAX_EXPONENT = 40;
+    static constexpr int BUCKET_COUNT = (MAX_EXPONENT - SUB_BUCKET_BITS + 2) * SUB_BUCKETS;
+
+    void record(uint64_t nanoseconds) {
+        std::atomic<uint64_t>& bucket = buckets[bucketIndex(nanoseconds)];
+        bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    uint64_t getCount(int bucket) const { return buckets[bucket].load(std::memory_order_relaxed); }
+    uint64_t getTotalCount() const;
+    
+    // Midpoint of the bucket holding the given fraction of all samples
+    uint64_t getPercentile(double fraction) const;
+
+    static int bucketIndex(uint64_t value);
+    static uint64_t bucketLowerBound(int bucket);
+    static uint64_t bucketUpperBound(int bucket);
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets{};
+};
+
+// Process-wide registry of per-thread stage histograms
+class FrameProfiler {
+public:
+    static void setEnabled(bool enabled) { enabledFlag.store(enabled, std::memory_order_relaxed); }
+    static bool isEnabled() { return enabledFlag.load(std::memory_order_relaxed); }
+
+    // Label the calling thread in reports
+    static void setThreadName(const std::string& name);
+
+    // Record a duration for the calling thread
+    static void record(FrameStage stage, uint64_t nanoseconds);
+
+    // Write every thread's stages recorded since the previous report
+    static void report(std::ostream& out);
+
+private:
+    static std::atomic<bool> enabledFlag;
+};
+
+// Times the enclosing scope into the calling thread's histogram for a stage
+class ScopedStageTimer {
+public:
+    explicit ScopedStageTimer(FrameStage stage)
+        : stage(stage), active(FrameProfiler::isEnabled()) {
+        if (active) {
+            startTime = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~ScopedStageTimer() {
+        if (active) {
+            auto elapsed = std::chrono::steady_clock::now() - startTime;
+            FrameProfiler::record(stage, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        }
+    }
+
+    ScopedStageTimer(const ScopedStageTimer&) = delete;
+    ScopedStageTimer& operator=(const ScopedStageTimer&) = delete;
+
+private:
+    FrameStage stage;
+    bool active;
+    std::chrono::steady_clock::time_point startTime;
+};
+
+} // namespace LEDCube
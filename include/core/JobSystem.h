@@ -0,0 +1,137 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace LEDCube {
+
+// Where the job system's workers run
+struct JobSystemOptions {
+    int workers = -1;              // -1: one per allowed core, less one for the submitting thread
+    std::vector<int> cpus;         // Cores workers may run on; empty = all
+    std::vector<int> excludedCpus; // Never run workers here, e.g. the display thread's isolated core
+};
+
+// Counts unfinished jobs, for waiting on a batch (typically everything a
+// frame submitted) and for starting jobs once a batch is done. Reusable
+// once it reaches zero; must outlive its jobs.
+class JobCounter {
+public:
+    JobCounter() = default;
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    bool isDone() const { return pending.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+
+    struct Continuation {
+        std::function<void()> job;
+        JobCounter* counter;
+    };
+
+    std::atomic<int> pending{0};
+    std::mutex mutex;
+    std::vector<Continuation> continuations; // Submitted when pending drops to zero
+};
+
+// Fixed pool of worker threads, each with its own deque of tasks. A worker
+// runs its newest task first (what it just split off is still in cache)
+// and, when out of work, steals the oldest task of another deque. Threads
+// outside the pool submit into a shared deque that workers steal from.
+//
+// Waiting never blocks on work: wait() and parallelFor() run queued tasks
+// until what they wait for is done, so jobs may submit and wait on further
+// jobs, including nested parallelFor calls.
+class JobSystem {
+public:
+    explicit JobSystem(const JobSystemOptions& options = JobSystemOptions());
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // Process-wide instance for the animation, conversion and upload stages.
+    // configureShared must come before its first use and returns false
+    // (and keeps the running instance) afterwards.
+    static JobSystem& shared();
+    static bool configureShared(const JobSystemOptions& options);
+
+    int getWorkerCount() const { return static_cast<int>(workers.size()); }
+    // Threads that execute a parallelFor: the workers and the caller
+    int getThreadCount() const { return getWorkerCount() + 1; }
+    const std::vector<int>& getCpus() const { return cpus; }
+
+    // Queues a job; counter, if given, counts it until it has run. Without
+    // workers, jobs (and continuations) run on the thread that submits them.
+    void submit(std::function<void()> job, JobCounter* counter = nullptr);
+
+    // Queues a job to start once dependency has reached zero (at once if it
+    // already has)
+    void submitAfter(JobCounter& dependency, std::function<void()> job, JobCounter* counter = nullptr);
+
+    // Runs queued jobs until counter reaches zero
+    void wait(JobCounter& counter);
+
+    // Runs body over [0, count) in ranges of at most grain indices, in
+    // parallel, and returns when all have run. Does not allocate.
+    void parallelFor(int count, int grain, const std::function<void(int begin, int end)>& body);
+
+private:
+    // A queued unit of work: run(context, index)
+    struct Task {
+        void (*run)(void* context, int index);
+        void* context;
+        int index;
+        JobCounter* counter;
+    };
+
+    // Bounded deque; the owner pushes and pops at the back, thieves take
+    // from the front
+    class TaskDeque {
+    public:
+        static constexpr int CAPACITY = 1024;
+
+        TaskDeque() : tasks(CAPACITY), head(0), tail(0) {}
+
+        bool push(const Task& task);
+        bool pop(Task& task);
+        bool steal(Task& task);
+
+    private:
+        std::mutex mutex;
+        std::vector<Task> tasks;
+        uint64_t head; // Oldest task
+        uint64_t tail; // One past the newest task
+    };
+
+    std::vector<std::thread> workers;
+    std::vector<int> cpus;
+    // One per worker, then the deque for threads outside the pool
+    std::vector<std::unique_ptr<TaskDeque>> deques;
+
+    std::atomic<int> queuedTasks;
+    std::atomic<int> sleepingWorkers;
+    std::atomic<bool> stopping;
+    std::mutex sleepMutex;
+    std::condition_variable wakeUp;
+
+    void workerLoop(int index);
+    int currentDeque() const;
+    void push(const Task& task);
+    bool findTask(int home, Task& task);
+    void execute(const Task& task);
+    void finish(JobCounter* counter);
+    void help(int home, JobCounter& counter);
+
+    static void runJob(void* context, int index);
+};
+
+} // namespace LEDCube
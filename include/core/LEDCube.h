@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vector>
+#include <array>
 #include <cstdint>
 #include <memory>
 
@@ -18,6 +19,9 @@ struct Color {
     Color() : r(0), g(0), b(0) {}
     Color(uint8_t red, uint8_t green, uint8_t blue) : r(red), g(green), b(blue) {}
     
+    bool operator==(const Color& other) const { return r == other.r && g == other.g && b == other.b; }
+    bool operator!=(const Color& other) const { return !(*this == other); }
+    
     // Common colors
     static Color Black() { return Color(0, 0, 0); }
     static Color White() { return Color(255, 255, 255); }
@@ -43,6 +47,10 @@ struct Position {
     }
 };
 
+// Per-face dirty row masks: bit y of entry z is set when row y of face z changed
+using DirtyMasks = std::array<uint64_t, CUBE_DEPTH>;
+constexpr uint64_t ALL_ROWS_DIRTY = ~uint64_t(0);
+
 // Main LED Cube class
 class LEDCube {
 public:
@@ -59,6 +67,25 @@ public:
     const std::vector<Color>& getBuffer() const { return buffer; }
     void setBuffer(const std::vector<Color>& newBuffer);
     
+    // Copies the given rows of another cube and takes over its dirty
+    // tracking; the other rows must already match
+    void copyFrom(const LEDCube& other, const DirtyMasks& rows);
+    
+    // Direct row access for renderers that write whole rows at a time,
+    // possibly from several threads. Report the rows afterwards with
+    // commitRows (written: rows overwritten, changed: rows whose pixels
+    // differ, lit: written rows holding non-black pixels) to keep the
+    // dirty tracking right.
+    Color* getRow(int face, int y) { return buffer.data() + face * (CUBE_SIZE * CUBE_SIZE) + y * CUBE_SIZE; }
+    void commitRows(int face, uint64_t written, uint64_t changed, uint64_t lit);
+    
+    // Dirty-region tracking (rows changed since the last resetDirty)
+    uint64_t getDirtyRows(int face) const { return dirtyRows[face]; }
+    const DirtyMasks& getDirtyMasks() const { return dirtyRows; }
+    bool isDirty() const;
+    void resetDirty();
+    void markAllDirty();
+    
     // Utility functions
     bool isValidPosition(const Position& pos) const;
     int positionToIndex(const Position& pos) const;
@@ -72,6 +99,10 @@ public:
 
 private:
     std::vector<Color> buffer;
+    
+    // Rows modified since the last reset, and rows that may hold non-black pixels
+    DirtyMasks dirtyRows;
+    DirtyMasks litRows;
 };
 
 } // namespace LEDCube 
\ No newline at end of file
@@ -1,21 +1,43 @@
 #pragma once
 
 #include "LEDCube.h"
+#include "PixelFormat.h"
 #include <vector>
 #include <cstdint>
 
 namespace LEDCube {
 
+// Pixel order of a MatrixBuffer
+enum class BufferLayout {
+    FaceMajor,  // Face, row, column: the LEDCube order
+    ScanOrder   // HUB75 order of one 1:32-scan chain with face k at position k:
+                // row pair, then clocked column (face 5 first, x ascending),
+                // then upper (y < 32) / lower half, so a row pair is contiguous
+};
+
 // Matrix buffer for efficient LED data handling
 class MatrixBuffer {
 public:
-    MatrixBuffer();
+    static constexpr int SCAN_ROW_PAIRS = CUBE_SIZE / 2;
+    static constexpr int SCAN_COLUMNS = CUBE_SIZE * CUBE_DEPTH;
+    
+    explicit MatrixBuffer(BufferLayout layout = BufferLayout::FaceMajor);
     ~MatrixBuffer();
     
     // Buffer management
+    // setBuffer takes face-major colors; getBuffer is in the buffer's layout
     void setBuffer(const std::vector<Color>& colors);
     const std::vector<Color>& getBuffer() const { return buffer; }
     
+    // Reorders the pixels in place; dirty rows are kept
+    void setLayout(BufferLayout newLayout);
+    BufferLayout getLayout() const { return layout; }
+    
+    // Index of a pixel in a layout, and whole-frame reordering between
+    // layouts (source and destination must not overlap)
+    static int layoutIndex(BufferLayout layout, int x, int y, int face);
+    static void convertLayout(const Color* source, BufferLayout from, Color* destination, BufferLayout to);
+    
     // LED control
     void setLED(const Position& pos, const Color& color);
     Color getLED(const Position& pos) const;
@@ -23,9 +45,21 @@ public:
     // Buffer operations
     void clear();
     void fill(const Color& color);
+    // Both keep this buffer's layout, reordering the pixels if needed
     void copyFrom(const MatrixBuffer& other);
+    void copyFrom(const LEDCube& cube);  // Copies pixels and the cube's dirty rows
+    
+    // Dirty-region tracking (rows changed relative to the previous frame)
+    uint64_t getDirtyRows(int face) const { return dirtyRows[face]; }
+    const DirtyMasks& getDirtyMasks() const { return dirtyRows; }
+    bool isDirty() const;
+    void resetDirty();
+    void markAllDirty();
     
-    // Data conversion for different output formats
+    // Data conversion for different output formats, in the buffer's layout
+    // convertTo writes into a caller-owned buffer of at least
+    // getSize() * bytesPerPixel(format) bytes and never allocates
+    void convertTo(PixelFormat format, uint8_t* destination, size_t destinationSize, uint8_t brightness = 255) const;
     std::vector<uint8_t> toRGB888() const;
     std::vector<uint8_t> toRGB565() const;
     std::vector<uint8_t> toRawBytes() const;
@@ -41,10 +75,8 @@ public:
 
 private:
     std::vector<Color> buffer;
-    
-    // Helper methods for data conversion
-    uint16_t colorToRGB565(const Color& color) const;
-    Color rgb565ToColor(uint16_t rgb565) const;
+    DirtyMasks dirtyRows;
+    BufferLayout layout;
 };
 
 } // namespace LEDCube 
\ No newline at end of file
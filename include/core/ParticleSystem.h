@@ -0,0 +1,52 @@
+#pragma once
+
+#include "LEDCube.h"
+#include <vector>
+#include <cstddef>
+
+namespace LEDCube {
+
+// Fixed-capacity particle pool stored as structure-of-arrays.
+// Positions are in cube coordinates (x, y in [0, CUBE_SIZE), z in [0, CUBE_DEPTH))
+// and kept as floats so sub-pixel motion accumulates between frames.
+class ParticleSystem {
+public:
+    explicit ParticleSystem(size_t capacity);
+
+    // Particle management
+    // Returns false when the pool is full. A negative lifetime never expires.
+    bool spawn(float x, float y, float z,
+               float vx, float vy, float vz,
+               const Color& color, float lifetime = -1.0f);
+    void kill(size_t index);
+    void clear() { count = 0; }
+
+    // Simulation
+    void integrate(float deltaTime, float ax = 0.0f, float ay = 0.0f, float az = 0.0f);
+    void removeDead();
+    void rasterize(LEDCube& cube) const;
+
+    // Pool info
+    size_t size() const { return count; }
+    size_t capacity() const { return posX.size(); }
+    bool isFull() const { return count == posX.size(); }
+
+    // Raw array access for custom per-particle passes (valid up to size())
+    float* positionX() { return posX.data(); }
+    float* positionY() { return posY.data(); }
+    float* positionZ() { return posZ.data(); }
+    float* velocityX() { return velX.data(); }
+    float* velocityY() { return velY.data(); }
+    float* velocityZ() { return velZ.data(); }
+    float* lifetimes() { return life.data(); }
+    Color* colors() { return color.data(); }
+
+private:
+    std::vector<float> posX, posY, posZ;
+    std::vector<float> velX, velY, velZ;
+    std::vector<float> life;
+    std::vector<Color> color;
+    size_t count;
+};
+
+} // namespace LEDCube
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "LEDCube.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace LEDCube {
+
+// Output byte layouts for pixel conversion
+enum class PixelFormat {
+    RGB888,     // R, G, B
+    BGR888,     // B, G, R
+    RGB565BE,   // 5-6-5 packed, high byte first
+    RGB565LE    // 5-6-5 packed, low byte first (native uint16_t on ARM/x86)
+};
+
+size_t bytesPerPixel(PixelFormat format);
+
+// Converts count pixels into destination, which must hold
+// count * bytesPerPixel(format) bytes and must not overlap source.
+// Brightness scales every channel by brightness/255 (rounded) before
+// packing; 255 leaves colors unchanged. 5-6-5 channels are truncated,
+// i.e. r5 = r * 31 / 255.
+void convertPixels(const Color* source, size_t count, uint8_t* destination,
+                   PixelFormat format, uint8_t brightness = 255);
+
+// Conversion kernels are chosen once from the CPU's features ("avx2",
+// "ssse3", "neon" or "scalar"); selecting another one is meant for
+// benchmarks and verification
+const char* getPixelKernel();
+std::vector<std::string> getAvailablePixelKernels();
+bool setPixelKernel(const std::string& name);
+
+} // namespace LEDCube
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "FrameProfiler.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace LEDCube {
+
+// Scheduling setup for latency-critical threads
+struct RealtimeOptions {
+    int priority = 0;         // SCHED_FIFO priority 1-99; 0 keeps normal scheduling
+    int cpu = -1;             // Pin to this core (ideally one isolated with isolcpus=); -1 = any
+    bool lockMemory = false;  // mlockall() so page faults cannot stall the thread
+};
+
+class Realtime {
+public:
+    // Each applies to the calling thread (lockMemory to the whole process)
+    // and reports failure, typically missing CAP_SYS_NICE / CAP_IPC_LOCK,
+    // on std::cerr
+    static bool setPriority(int priority);
+    static bool pinToCpu(int cpu);
+    static bool pinToCpus(const std::vector<int>& cpus);
+    static bool lockMemory();
+    static bool apply(const RealtimeOptions& options);
+
+    static int getCpuCount();
+
+    // Sleeps with clock_nanosleep(TIMER_ABSTIME) until spinWindow before the
+    // deadline, then busy-waits the rest so wake-up latency stays out of it.
+    // steady_clock is CLOCK_MONOTONIC on Linux.
+    static void waitUntil(std::chrono::steady_clock::time_point deadline,
+                          std::chrono::nanoseconds spinWindow = std::chrono::microseconds(20));
+};
+
+// Lateness of periodic deadlines (e.g. the start of every scanned row)
+struct JitterStats {
+    uint64_t count = 0;
+    uint64_t overruns = 0;   // Deadlines missed by a whole period or more
+    double p50Us = 0.0;
+    double p99Us = 0.0;
+    double maxUs = 0.0;
+};
+
+// Written by one thread, readable from any
+class JitterMonitor {
+public:
+    void record(std::chrono::steady_clock::time_point deadline,
+                std::chrono::steady_clock::time_point actual,
+                std::chrono::nanoseconds period);
+    JitterStats getStats() const;
+
+private:
+    LatencyHistogram histogram;
+    std::atomic<uint64_t> overruns{0};
+    std::atomic<uint64_t> maxLateness{0};
+};
+
+} // namespace LEDCube
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace LEDCube {
+
+// Frame pacing counters reported by TripleBuffer
+struct FrameHandoffStats {
+    uint64_t framesProduced = 0;   // Frames published by the producer
+    uint64_t framesDisplayed = 0;  // Frames latched by the consumer
+    uint64_t framesDropped = 0;    // Frames overwritten before they were latched
+};
+
+// Lock-free single-producer / single-consumer triple buffer.
+//
+// The producer owns the back slot and renders into it in place, then
+// publishes it with one atomic exchange against the shared middle slot.
+// The consumer latches the newest complete frame by exchanging its front
+// slot with the middle slot, but only when a fresh frame is waiting.
+// Neither side ever blocks or copies the other side's frame.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : state(MIDDLE_INITIAL), backIndex(BACK_INITIAL), frontIndex(FRONT_INITIAL) {}
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // Producer side
+    T& acquireBack() { return slots[backIndex]; }
+
+    void publish() {
+        sequences[backIndex] = ++produced;
+
+        uint8_t previous = state.exchange(static_cast<uint8_t>(backIndex | FRESH_BIT),
+                                          std::memory_order_acq_rel);
+        backIndex = previous & INDEX_MASK;
+
+        if (previous & FRESH_BIT) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        producedCount.store(produced, std::memory_order_relaxed);
+    }
+
+    // Consumer side: returns true if a new frame was latched
+    bool latch() {
+        if ((state.load(std::memory_order_relaxed) & FRESH_BIT) == 0) {
+            return false;
+        }
+
+        uint8_t previous = state.exchange(static_cast<uint8_t>(frontIndex), std::memory_order_acq_rel);
+        frontIndex = previous & INDEX_MASK;
+        displayed.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    const T& front() const { return slots[frontIndex]; }
+    T& front() { return slots[frontIndex]; }
+
+    // Producer sequence number of the frame currently in front (0 = none yet)
+    uint64_t frontSequence() const { return sequences[frontIndex]; }
+
+    // Direct slot access for setup before the threads are started
+    T& slot(int index) { return slots[index]; }
+    static constexpr int slotCount() { return SLOT_COUNT; }
+
+    // Statistics (safe to read from any thread)
+    FrameHandoffStats getStats() const {
+        FrameHandoffStats stats;
+        stats.framesProduced = producedCount.load(std::memory_order_relaxed);
+        stats.framesDisplayed = displayed.load(std::memory_order_relaxed);
+        stats.framesDropped = dropped.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+private:
+    static constexpr int SLOT_COUNT = 3;
+    static constexpr uint8_t INDEX_MASK = 0x03;
+    static constexpr uint8_t FRESH_BIT = 0x04;
+    static constexpr uint8_t BACK_INITIAL = 0;
+    static constexpr uint8_t MIDDLE_INITIAL = 1;
+    static constexpr uint8_t FRONT_INITIAL = 2;
+
+    std::array<T, SLOT_COUNT> slots;
+    std::array<uint64_t, SLOT_COUNT> sequences{};
+
+    // Middle slot index plus "fresh frame waiting" flag
+    std::atomic<uint8_t> state;
+
+    // Owned by the producer
+    alignas(64) uint8_t backIndex;
+    uint64_t produced = 0;
+
+    // Owned by the consumer
+    alignas(64) uint8_t frontIndex;
+
+    // Counters
+    alignas(64) std::atomic<uint64_t> producedCount{0};
+    std::atomic<uint64_t> displayed{0};
+    std::atomic<uint64_t> dropped{0};
+};
+
+} // namespace LEDCube
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "GPIOController.h"
+#include "PixelMapper.h"
+#include "ColorLUT.h"
+#include "../core/MatrixBuffer.h"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace LEDCube {
+
+// Binary code modulation (BCM) frame encoder for HUB75 panel chains.
+//
+// The six 64x64 faces sit on one to three parallel chains (ChainLayout)
+// with 1:32 scan: each of the 32 row pairs drives face rows y (R1/G1/B1)
+// and y + 32 (R2/G2/B2) at once, and every row shifts getChainLength()
+// columns. A frame is stored as bitDepth planes of ready-to-write GPIO
+// words per row pair, in clock order, so scan-out only streams words:
+// plane b is shown for (base time << b). Each word carries the column of
+// every chain, so one store feeds all chains.
+//
+// The first word shifted travels to the far end of a chain, so words
+// [0, 64) of a row feed the last panel position and the final 64 words
+// the panel at position 0; within a panel, columns are clocked in panel x
+// order. Panel rows are gathered from the buffer through the PixelMapper,
+// which also supplies the chain layout.
+class BitplaneEncoder {
+public:
+    static constexpr int MIN_BIT_DEPTH = 8;
+    static constexpr int MAX_BIT_DEPTH = 11;
+    static constexpr int ROW_PAIRS = CUBE_SIZE / 2;
+    static constexpr int MAX_CHAIN_LENGTH = CUBE_SIZE * CUBE_DEPTH;
+    static constexpr uint32_t ALL_ROW_PAIRS = 0xFFFFFFFFu; // One bit per row pair
+
+    // GPIO words
+    static constexpr uint32_t ADDRESS_MASK =
+        (1u << GPIOPins::ADDR_A) | (1u << GPIOPins::ADDR_B) | (1u << GPIOPins::ADDR_C) |
+        (1u << GPIOPins::ADDR_D) | (1u << GPIOPins::ADDR_E);
+
+    explicit BitplaneEncoder(int bitDepth = MAX_BIT_DEPTH, const PixelMapper& mapper = PixelMapper());
+
+    // Settings; all invalidate every plane, so the next encode must be full.
+    // setLayout keeps the face orientations and throws
+    // std::invalid_argument for an invalid layout.
+    void setMapper(const PixelMapper& mapper);
+    const PixelMapper& getMapper() const { return mapper; }
+    void setLayout(const ChainLayout& layout);
+    const ChainLayout& getLayout() const { return mapper.getLayout(); }
+    void setBitDepth(int bits);
+    int getBitDepth() const { return bitDepth; }
+    void setColorSettings(const ColorSettings& settings);
+    const ColorSettings& getColorSettings() const { return colors.getSettings(); }
+    void setBrightness(double level); // 0.0 to 1.0, kept with the other color settings
+    double getBrightness() const { return colors.getSettings().brightness; }
+
+    // Re-encodes the panel rows showing the buffer's dirty rows, or every
+    // row when full is set. A full encode of a BufferLayout::ScanOrder
+    // buffer under a scan-native mapping reads the buffer sequentially.
+    // Returns the row pairs rewritten, one bit each.
+    uint32_t encode(const MatrixBuffer& buffer, bool full);
+    void encodeRow(const MatrixBuffer& buffer, int face, int panelY);
+
+    // Columns clocked per row, and the color data pins of all chains
+    int getChainLength() const { return chainLength; }
+    uint32_t getDataMask() const { return dataMask; }
+
+    // getChainLength() GPIO words (getDataMask() bits only) for one row pair and plane
+    const uint32_t* getRowPlane(int rowPair, int plane) const {
+        return planes.data() + (static_cast<size_t>(plane) * ROW_PAIRS + rowPair) * chainLength;
+    }
+
+    // GPIO word selecting a row pair (ADDRESS_MASK bits only)
+    static uint32_t rowAddressBits(int rowPair);
+
+    // Intensity levels (0 to 2^bitDepth - 1) the 8-bit channel values encode to
+    const ColorLUT& getColorLUT() const { return colors; }
+
+    size_t getPlaneBytes() const { return planes.size() * sizeof(uint32_t); }
+
+private:
+    PixelMapper mapper;
+    int chainLength;
+    uint32_t dataMask;
+    int bitDepth;
+    ColorLUT colors;
+    std::vector<uint32_t> planes;
+
+    // GPIO bits for each 3-bit RGB value, by chain and half (0 = upper)
+    std::array<std::array<std::array<uint32_t, 8>, 2>, ChainLayout::MAX_CHAINS> pinBits;
+
+    void allocatePlanes();
+    void encodeScanOrder(const MatrixBuffer& buffer);
+};
+
+} // namespace LEDCube
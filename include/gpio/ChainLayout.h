@@ -0,0 +1,67 @@
+#pragma once
+
+#include "GPIOController.h"
+#include "../core/LEDCube.h"
+#include <array>
+#include <cstdint>
+
+namespace LEDCube {
+
+// Color data pins of one HUB75 output. CLK, LAT, OE and ADDR A-E are shared
+// by every chain.
+struct ChainPins {
+    int r1, g1, b1; // Upper half
+    int r2, g2, b2; // Lower half
+
+    uint32_t upperMask() const { return (1u << r1) | (1u << g1) | (1u << b1); }
+    uint32_t lowerMask() const { return (1u << r2) | (1u << g2) | (1u << b2); }
+    uint32_t mask() const { return upperMask() | lowerMask(); }
+};
+
+// Place of a face's panel: which output chain, and how many panels lie
+// between it and the controller on that chain (0 = first)
+struct PanelSlot {
+    int chain = 0;
+    int position = 0;
+};
+
+// Assignment of the six faces to up to MAX_CHAINS parallel HUB75 chains.
+// All chains are shifted by the same GPIO word writes, so a row takes as
+// many clocks as the longest chain has columns: two or three chains cut
+// the shift time per row to a half or a third.
+struct ChainLayout {
+    static constexpr int MAX_CHAINS = 3;
+    static constexpr std::array<ChainPins, MAX_CHAINS> PINS = {{
+        {GPIOPins::R1_PIN, GPIOPins::G1_PIN, GPIOPins::B1_PIN, GPIOPins::R2_PIN, GPIOPins::G2_PIN, GPIOPins::B2_PIN},
+        {GPIOPins::CHAIN2_R1_PIN, GPIOPins::CHAIN2_G1_PIN, GPIOPins::CHAIN2_B1_PIN,
+         GPIOPins::CHAIN2_R2_PIN, GPIOPins::CHAIN2_G2_PIN, GPIOPins::CHAIN2_B2_PIN},
+        {GPIOPins::CHAIN3_R1_PIN, GPIOPins::CHAIN3_G1_PIN, GPIOPins::CHAIN3_B1_PIN,
+         GPIOPins::CHAIN3_R2_PIN, GPIOPins::CHAIN3_G2_PIN, GPIOPins::CHAIN3_B2_PIN},
+    }};
+
+    int chainCount = 1;
+    std::array<PanelSlot, CUBE_DEPTH> faces; // Indexed by face
+
+    // Every face on chain 0, face k at position k
+    ChainLayout();
+
+    // Faces dealt round-robin over chainCount chains: face k goes to chain
+    // k % chainCount at position k / chainCount
+    static ChainLayout interleaved(int chainCount);
+
+    // Throws std::invalid_argument unless chainCount is 1 to MAX_CHAINS and
+    // every face has its own slot on one of the chains
+    void validate() const;
+
+    // Panels on the longest chain, and the columns shifted per row
+    int getPanelsPerChain() const;
+    int getChainLength() const { return getPanelsPerChain() * CUBE_SIZE; }
+
+    // Face at a slot, or -1 if the slot is empty
+    int getFaceAt(int chain, int position) const;
+
+    // Color data pins of all chains in use
+    uint32_t getDataMask() const;
+};
+
+} // namespace LEDCube
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "../core/LEDCube.h"
+#include <array>
+#include <cstdint>
+
+namespace LEDCube {
+
+// Per-channel gains, 1.0 = unchanged
+struct ChannelGains {
+    double r = 1.0;
+    double g = 1.0;
+    double b = 1.0;
+
+    double operator[](int channel) const { return channel == 0 ? r : (channel == 1 ? g : b); }
+    bool operator==(const ChannelGains& other) const { return r == other.r && g == other.g && b == other.b; }
+    bool operator!=(const ChannelGains& other) const { return !(*this == other); }
+};
+
+// Output color correction, applied in this order to every 8-bit channel:
+// gamma decode to linear light, then the white-balance, face-calibration
+// and brightness gains. Results above full scale clip.
+struct ColorSettings {
+    double gamma = 2.2;                                   // 1.0 = linear
+    double brightness = 1.0;                              // 0.0 to 1.0
+    ChannelGains whiteBalance;                            // White point of the panels
+    std::array<ChannelGains, CUBE_DEPTH> faceCalibration; // Per-face correction on top
+
+    bool operator==(const ColorSettings& other) const {
+        return gamma == other.gamma && brightness == other.brightness &&
+               whiteBalance == other.whiteBalance && faceCalibration == other.faceCalibration;
+    }
+    bool operator!=(const ColorSettings& other) const { return !(*this == other); }
+};
+
+// 8-bit channel value -> BCM intensity level (0 to 2^bitDepth - 1) for
+// every face and channel. All corrections fold into the table, so the
+// encoder pays one lookup per channel whatever the settings are; it is
+// rebuilt only when the settings or bit depth change.
+class ColorLUT {
+public:
+    ColorLUT();
+
+    // Rebuilds the tables if the settings or depth differ from the current ones
+    void update(const ColorSettings& settings, int bitDepth);
+
+    const ColorSettings& getSettings() const { return settings; }
+    int getBitDepth() const { return bitDepth; }
+
+    // 256 levels of one channel (0 = R, 1 = G, 2 = B) of a face
+    const uint16_t* getTable(int face, int channel) const {
+        return tables.data() + (face * 3 + channel) * 256;
+    }
+    uint16_t getLevel(int face, int channel, uint8_t value) const { return getTable(face, channel)[value]; }
+
+private:
+    ColorSettings settings;
+    int bitDepth;
+    std::array<uint16_t, CUBE_DEPTH * 3 * 256> tables;
+
+    void rebuild();
+};
+
+} // namespace LEDCube
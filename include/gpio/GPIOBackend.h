@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+namespace LEDCube {
+
+// Pin I/O used by GPIOController. Pins are bits of a 64-bit mask
+// (bank 0 = GPIO 0-31, bank 1 = GPIO 32-63).
+class GPIOBackend {
+public:
+    virtual ~GPIOBackend() = default;
+
+    // Drives the pins in setMask high and those in clearMask low;
+    // the masks must not overlap
+    virtual void write(uint64_t setMask, uint64_t clearMask) = 0;
+    virtual uint64_t read() const = 0;
+    virtual void setPinMode(int pin, int mode) = 0; // 0 = input, 1 = output
+
+    // Holds the pins as they are; spins on the clock by default, since
+    // sub-microsecond sleeps are not possible
+    virtual void delayNanoseconds(uint64_t nanoseconds);
+
+    virtual const char* getName() const = 0;
+};
+
+// BCM2835-family GPIO register block (Pi 1-4) accessed through memory:
+// a mapping of /dev/gpiomem on hardware, a mapped regular file as a
+// stand-in, or any plain memory region. Each write() is at most one store
+// per bank to GPSET and one to GPCLR, however many pins change.
+class MappedGPIOBackend : public GPIOBackend {
+public:
+    // Register word offsets within the block
+    static constexpr int GPFSEL0 = 0x00 / 4;
+    static constexpr int GPSET0 = 0x1C / 4;
+    static constexpr int GPCLR0 = 0x28 / 4;
+    static constexpr int GPLEV0 = 0x34 / 4;
+    static constexpr size_t BLOCK_SIZE = 4096;
+    static constexpr int PIN_COUNT = 54;
+
+    // Owns a zeroed in-process register block (mock hardware)
+    MappedGPIOBackend();
+
+    // Maps BLOCK_SIZE bytes of a device or file at offset; regular files
+    // are extended as needed, and created if createFile is set (never use
+    // it with a device path). Throws std::runtime_error on failure.
+    explicit MappedGPIOBackend(const std::string& path, off_t offset = 0, bool createFile = false);
+
+    // Uses caller-owned memory of at least BLOCK_SIZE bytes
+    explicit MappedGPIOBackend(volatile uint32_t* registers);
+
+    ~MappedGPIOBackend() override;
+
+    MappedGPIOBackend(const MappedGPIOBackend&) = delete;
+    MappedGPIOBackend& operator=(const MappedGPIOBackend&) = delete;
+
+    void write(uint64_t setMask, uint64_t clearMask) override;
+    uint64_t read() const override;
+    void setPinMode(int pin, int mode) override;
+
+    const char* getName() const override { return name.c_str(); }
+    volatile uint32_t* getRegisters() const { return registers; }
+
+private:
+    volatile uint32_t* registers;
+    std::vector<uint32_t> ownedRegisters;
+    void* mapping;
+    int fd;
+    std::string name;
+};
+
+} // namespace LEDCube
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "GPIOBackend.h"
 #include <cstdint>
 #include <vector>
 #include <memory>
@@ -19,7 +20,35 @@ struct GPIOPins {
     static constexpr int ADDR_B = 13;        // GPIO 13
     static constexpr int ADDR_C = 14;        // GPIO 14
     static constexpr int ADDR_D = 15;        // GPIO 15
+    static constexpr int ADDR_E = 24;        // GPIO 24 (1:32 scan)
     
+    // HUB75 color data: upper half (R1/G1/B1) and lower half (R2/G2/B2)
+    static constexpr int R1_PIN = 18;        // GPIO 18
+    static constexpr int G1_PIN = 19;        // GPIO 19
+    static constexpr int B1_PIN = 20;        // GPIO 20
+    static constexpr int R2_PIN = 21;        // GPIO 21
+    static constexpr int G2_PIN = 22;        // GPIO 22
+    static constexpr int B2_PIN = 23;        // GPIO 23
+
+    // Color data of the second and third parallel chains (see ChainLayout);
+    // these are only configured when the chain is in use. The second chain
+    // takes the header's free pins. That leaves no free pins for a third
+    // chain; GPIO 0/1 stay reserved for the HAT ID EEPROM, so it takes over
+    // I2C (GPIO 2/3), SPI MOSI (DATA_PIN) and the Reset and Blank lines,
+    // which HUB75 panels do not have.
+    static constexpr int CHAIN2_R1_PIN = 4;  // GPIO 4
+    static constexpr int CHAIN2_G1_PIN = 5;  // GPIO 5
+    static constexpr int CHAIN2_B1_PIN = 6;  // GPIO 6
+    static constexpr int CHAIN2_R2_PIN = 7;  // GPIO 7 (SPI0 CE1, unused)
+    static constexpr int CHAIN2_G2_PIN = 25; // GPIO 25
+    static constexpr int CHAIN2_B2_PIN = 26; // GPIO 26
+    static constexpr int CHAIN3_R1_PIN = 27; // GPIO 27
+    static constexpr int CHAIN3_G1_PIN = 2;  // GPIO 2 (I2C1 SDA)
+    static constexpr int CHAIN3_B1_PIN = 3;  // GPIO 3 (I2C1 SCL)
+    static constexpr int CHAIN3_R2_PIN = 16; // GPIO 16 (RESET_PIN)
+    static constexpr int CHAIN3_G2_PIN = 17; // GPIO 17 (BLANK_PIN)
+    static constexpr int CHAIN3_B2_PIN = 10; // GPIO 10 (DATA_PIN)
+
     // Additional control pins
     static constexpr int RESET_PIN = 16;     // GPIO 16
     static constexpr int BLANK_PIN = 17;     // GPIO 17
@@ -27,7 +56,8 @@ struct GPIOPins {
 
 class GPIOController {
 public:
-    GPIOController();
+    // Without a backend, initialize() uses an in-memory register block
+    explicit GPIOController(std::unique_ptr<GPIOBackend> backend = nullptr);
     ~GPIOController();
     
     // Initialization
@@ -39,6 +69,7 @@ public:
     void setPin(int pin, bool state);
     bool getPin(int pin) const;
     void setPinMode(int pin, int mode);
+    void writeBits(uint32_t value, uint32_t mask); // Pins in mask take their bit of value
     
     // SPI operations
     void spiWrite(const std::vector<uint8_t>& data);
@@ -47,6 +78,7 @@ public:
     // Timing control
     void delayMicroseconds(unsigned int microseconds);
     void delayMilliseconds(unsigned int milliseconds);
+    void delayNanoseconds(unsigned int nanoseconds); // Precise hold; busy-waits on hardware
     
     // Matrix-specific operations
     void setLayer(int layer);
@@ -54,15 +86,25 @@ public:
     void latchData();
     void resetMatrix();
     
-    // Utility
+    // Hands these pins to the extra HUB75 chains, replacing the previous
+    // set; false, changing nothing, if the SPI path has already used one of
+    // them. spiWrite and resetMatrix do nothing while their pins are taken.
+    bool setChainPins(uint64_t mask);
+    
+    // Utility; these only touch the pins configured as outputs here
     void setAllPinsLow();
     void setAllPinsHigh();
+    const GPIOBackend* getBackend() const { return backend.get(); }
 
 private:
     bool initialized;
+    std::unique_ptr<GPIOBackend> backend;
     
-    // Pin state tracking
-    std::vector<bool> pinStates;
+    // Pin state tracking (shadow of the driven output levels)
+    uint64_t pinStates;
+    uint64_t outputPins; // Pins this controller set to output mode
+    uint64_t chainPins;  // Pins carrying color data of extra chains
+    bool spiUsed;
     std::vector<int> pinModes;
     
     // Helper methods
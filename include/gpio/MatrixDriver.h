@@ -1,16 +1,25 @@
 #pragma once
 
 #include "GPIOController.h"
+#include "BitplaneEncoder.h"
+#include "ScanGovernor.h"
+#include "PowerLimiter.h"
 #include "../core/MatrixBuffer.h"
+#include "../core/TripleBuffer.h"
+#include "../core/Realtime.h"
+#include <array>
 #include <memory>
 #include <thread>
 #include <atomic>
+#include <mutex>
+#include <vector>
 
 namespace LEDCube {
 
 class MatrixDriver {
 public:
-    MatrixDriver();
+    // The GPIO backend defaults to GPIOController's in-memory registers
+    explicit MatrixDriver(std::unique_ptr<GPIOBackend> gpioBackend = nullptr);
     ~MatrixDriver();
     
     // Initialization
@@ -18,59 +27,172 @@ public:
     void shutdown();
     bool isInitialized() const { return initialized; }
     
-    // Buffer management
+    // Buffer management (producer side)
+    // Render into the back buffer in place, then present it: its dirty rows
+    // are encoded on the calling thread and the finished bit planes handed
+    // to the display thread. The back buffer keeps the presented frame, so
+    // rows not marked dirty are assumed unchanged from it.
+    MatrixBuffer& acquireBackBuffer();
+    void presentBackBuffer();
+    
+    // Convenience wrappers that copy into the back buffer and present it
     void setBuffer(const MatrixBuffer& buffer);
     void updateBuffer(const MatrixBuffer& buffer);
     
+    // Pixel order of the frame buffers; only while the display is stopped.
+    // With BufferLayout::ScanOrder, copying a frame in reorders it and full
+    // encodes read it sequentially (when the pixel mapping is scan-native).
+    bool setBufferLayout(BufferLayout layout);
+    BufferLayout getBufferLayout() const { return backBuffer.getLayout(); }
+    
+    // Frame handoff statistics (encoded frames)
+    FrameHandoffStats getFrameStats() const { return frames.getStats(); }
+    
     // Display control
+    // Thread options take effect on the next startDisplay()
+    void setDisplayThreadOptions(const RealtimeOptions& options) { displayOptions = options; }
+    const RealtimeOptions& getDisplayThreadOptions() const { return displayOptions; }
     void startDisplay();
     void stopDisplay();
     bool isDisplaying() const { return displayThreadRunning; }
     
+    // Adaptive bit depth and refresh rate from measured scan throughput.
+    // When enabled, the display thread calibrates on start and re-tunes
+    // every interval, overriding setBitDepth and setRefreshRate. Options
+    // take effect on the next startDisplay(); a new bit depth applies from
+    // the next presented frame.
+    void setScanGovernorOptions(const ScanGovernorOptions& options) { governorOptions = options; }
+    const ScanGovernorOptions& getScanGovernorOptions() const { return governorOptions; }
+    ScanOperatingPoint getOperatingPoint() const;
+    
     // Display settings
-    void setRefreshRate(int fps);
+    void setRefreshRate(int fps); // Full scans per second; rows are paced evenly within one
+    JitterStats getScanJitter() const { return rowJitter.getStats(); }
     int getRefreshRate() const { return refreshRate; }
     
     void setBrightness(double brightness); // 0.0 to 1.0
-    double getBrightness() const { return brightness; }
+    double getBrightness() const;
+    
+    // Gamma, white balance, per-face calibration and brightness; the
+    // encoder's lookup tables are rebuilt from them when the next frame is
+    // presented
+    void setColorSettings(const ColorSettings& settings);
+    ColorSettings getColorSettings() const;
+    
+    // Automatic brightness limiting to a supply budget, estimated from each
+    // frame's content; the latest estimate is in getPowerStats()
+    void setPowerBudget(const PowerBudget& budget);
+    PowerBudget getPowerBudget() const;
+    PowerStats getPowerStats() const;
+    
+    // BCM color depth per channel (8 to 11 bits) and the display time of
+    // the least significant bit plane; each higher plane doubles it
+    void setBitDepth(int bits);
+    int getBitDepth() const { return bitDepth; }
+    void setPlaneBaseTime(unsigned int nanoseconds);
+    unsigned int getPlaneBaseTime() const { return planeBaseTimeNs; }
+    
+    // Panel mapping: chain slot and orientation of every face. Only while
+    // the display is stopped; setChainLayout keeps the orientations.
+    // Both return false for an invalid layout.
+    bool setPixelMapper(const PixelMapper& mapper);
+    const PixelMapper& getPixelMapper() const { return encoder.getMapper(); }
+    bool setChainLayout(const ChainLayout& layout);
+    const ChainLayout& getChainLayout() const { return encoder.getLayout(); }
     
     // Layer control
     void setCurrentLayer(int layer);
     int getCurrentLayer() const { return currentLayer; }
     
+    // Frame encoding, run by presentBackBuffer on the producer thread:
+    // applies the power limit and settings, encodes the frame and hands its
+    // bit planes to the display thread. Only the dirty rows are re-encoded
+    // when sequence follows the last one.
+    void encodeFrame(const MatrixBuffer& buffer, uint64_t sequence);
+    const BitplaneEncoder& getEncoder() const { return encoder; }
+    
+    // Latches the newest encoded frame and refreshes it once on the calling
+    // thread, for tests and benchmarks (e.g. against a PanelSimulator) while
+    // the display is stopped
+    void renderFrame();
+    
     // Utility
     void clearDisplay();
     void testPattern();
     void setAllLEDs(const Color& color);
 
 private:
+    // Bit planes of one frame with what scan-out needs to shift them, so
+    // the display thread never touches the encoder
+    struct EncodedFrame {
+        std::vector<uint32_t> planes; // BitplaneEncoder plane order
+        int bitDepth = 0;
+        int chainLength = 0;
+        uint32_t dataMask = 0;
+        unsigned int outputScale = 1u << 16; // Lit share of each plane's time in 1/65536ths
+        uint64_t version = 0;                // encodeCount when the slot was last filled
+        
+        uint32_t* getRowPlane(int rowPair, int plane) {
+            return planes.data() + (static_cast<size_t>(plane) * BitplaneEncoder::ROW_PAIRS + rowPair) * chainLength;
+        }
+        const uint32_t* getRowPlane(int rowPair, int plane) const {
+            return planes.data() + (static_cast<size_t>(plane) * BitplaneEncoder::ROW_PAIRS + rowPair) * chainLength;
+        }
+    };
+    
     std::unique_ptr<GPIOController> gpio;
-    MatrixBuffer displayBuffer;
+    std::unique_ptr<GPIOBackend> gpioBackend; // Handed to gpio on initialize
+    
+    // Producer side: the frame being rendered and its bit planes,
+    // re-encoded per dirty row when presented
+    MatrixBuffer backBuffer;
+    BitplaneEncoder encoder;
+    uint64_t encodedSequence;
+    uint64_t encodeCount;
+    std::array<uint64_t, BitplaneEncoder::ROW_PAIRS> rowPairVersions; // encodeCount at each row pair's last change
+    std::atomic<bool> fullEncodeRequested;
+    
+    // Encoded frames on their way to the display thread; a slot is brought
+    // up to date by copying the row pairs changed since it was last filled
+    TripleBuffer<EncodedFrame> frames;
     
     // Display thread
     std::thread displayThread;
     std::atomic<bool> displayThreadRunning;
     std::atomic<bool> shouldStop;
+    RealtimeOptions displayOptions;
+    JitterMonitor rowJitter; // Lateness of each row pair's scan deadline
+    ScanGovernorOptions governorOptions;
+    ScanGovernor governor;                // Display thread only
+    ScanOperatingPoint operatingPoint;    // Published copy of the governor's choice
+    mutable std::mutex operatingPointMutex;
     
     // Display settings
-    int refreshRate;
-    double brightness;
+    std::atomic<int> refreshRate;
+    ColorSettings colorSettings;
+    PowerBudget powerBudget;
+    mutable std::mutex colorMutex; // Guards colorSettings and powerBudget
+    PowerLimiter limiter;          // Producer side
+    PowerStats powerStats;
+    mutable std::mutex powerStatsMutex;
+    std::atomic<int> bitDepth;
+    std::atomic<unsigned int> planeBaseTimeNs;
     int currentLayer;
     bool initialized;
     
     // Display loop
     void displayLoop();
-    void renderLayer(int layer);
-    void renderFrame();
+    void renderRowPair(const EncodedFrame& frame, int rowPair);
+    void renderPacedFrame(std::chrono::steady_clock::time_point start, std::chrono::nanoseconds rowPeriod);
+    void calibrateScan();
+    void applyOperatingPoint(const ScanOperatingPoint& point);
     
     // Helper methods
+    void resetEncodedFrames();
     void initializeGPIO();
+    bool configureChainPins(const ChainLayout& layout);
     void cleanupGPIO();
     void setupTiming();
-    
-    // Color conversion for hardware
-    uint16_t colorToHardwareFormat(const Color& color) const;
-    Color hardwareFormatToColor(uint16_t hwColor) const;
 };
 
 } // namespace LEDCube 
\ No newline at end of file
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "GPIOBackend.h"
+#include "ChainLayout.h"
+#include "../core/LEDCube.h"
+#include <vector>
+
+namespace LEDCube {
+
+// Scan-out figures measured by PanelSimulator since the last reset
+struct PanelStatistics {
+    double elapsedSeconds = 0.0;       // Virtual time
+    uint64_t pinWrites = 0;
+    uint64_t refreshes = 0;            // Completed passes over all row pairs
+    double refreshRate = 0.0;          // Hz
+    double outputDuty = 0.0;           // Fraction of time the panels were lit
+    double shortestPulseNs = 0.0;      // Shortest OE-enabled period
+    double longestPulseNs = 0.0;
+    double effectiveBitDepth = 0.0;    // log2(lit time per row pair and refresh / shortest pulse + 1)
+};
+
+// Virtual HUB75 chain behind the GPIOBackend interface. It models the
+// column shift registers (clocked on CLK rising edges), the output latches
+// (LAT rising edge), the ADDR A-E row-pair select and active-low OE, and
+// integrates how long every LED channel is lit on a virtual clock. Each
+// pin write takes writeTimeNs and delays advance the clock without waiting,
+// so a refresh simulates much faster than real time.
+//
+// Chain model: the panel at a ChainLayout slot shows that slot's face, and
+// all chains shift on the shared clock, each from its own color pins.
+// Shifted data enters at the input end, so the word clocked first ends up
+// in the far panel, and within a panel the column nearest the input is
+// x = 63. Data shifted past a chain's last panel is lost.
+class PanelSimulator : public GPIOBackend {
+public:
+    static constexpr int ROW_PAIRS = CUBE_SIZE / 2;
+
+    // Throws std::invalid_argument for an invalid layout
+    explicit PanelSimulator(uint64_t writeTimeNs = 20, const ChainLayout& layout = ChainLayout());
+
+    // GPIOBackend
+    void write(uint64_t setMask, uint64_t clearMask) override;
+    uint64_t read() const override { return pins; }
+    void setPinMode(int, int) override {}
+    void delayNanoseconds(uint64_t nanoseconds) override;
+    const char* getName() const override { return "panel simulator"; }
+
+    // Pin-toggle speed of the modeled controller
+    void setWriteTime(uint64_t nanoseconds) { writeTimeNs = nanoseconds; }
+    uint64_t getWriteTime() const { return writeTimeNs; }
+
+    // Clears accumulated light and statistics, keeping the latched state
+    void resetStatistics();
+    PanelStatistics getStatistics() const;
+
+    // Fraction of the elapsed time a channel (0 = R, 1 = G, 2 = B) of a
+    // panel pixel was lit
+    double getDutyCycle(int face, int x, int y, int channel) const;
+
+    // Displayed image: each channel's lit time relative to the time its
+    // row pair was lit, scaled to 0-255. For BCM this recovers
+    // level / (2^bits - 1) of every channel. Pixels are in panel
+    // coordinates, i.e. as seen before any PixelMapper orientation.
+    std::vector<Color> getImage() const;
+
+    const ChainLayout& getLayout() const { return layout; }
+
+private:
+    ChainLayout layout;
+    int chainLength;
+    uint32_t dataMask;
+    uint64_t writeTimeNs;
+    uint64_t now;
+    uint64_t pins;
+
+    // Shift registers of all chains as one ring of GPIO words (color pins
+    // only): shiftRegister[(shiftHead + p) % chainLength] holds every
+    // chain's bits at position p (0 = input end)
+    std::vector<uint32_t> shiftRegister;
+    int shiftHead;
+    std::vector<uint32_t> outputLatch;  // By chain position
+    std::vector<int> slotFaces;         // Face at (panel position * chainCount + chain), or -1
+
+    // Light integration
+    uint64_t litSince;
+    uint64_t outputOnSince;
+    int lastLitRowPair;
+    std::vector<uint64_t> channelOnTime;        // TOTAL_LEDS * 3
+    std::vector<uint64_t> rowPairOnTime;        // ROW_PAIRS
+    uint64_t statisticsStart;
+    uint64_t pinWrites;
+    uint64_t refreshes;
+    uint64_t shortestPulse;
+    uint64_t longestPulse;
+
+    bool outputEnabled() const;
+    int selectedRowPair() const;
+    void accumulateLight();
+};
+
+} // namespace LEDCube
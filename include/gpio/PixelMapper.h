@@ -0,0 +1,79 @@
+#pragma once
+
+#include "ChainLayout.h"
+#include "../core/LEDCube.h"
+#include "../core/MatrixBuffer.h"
+#include <array>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace LEDCube {
+
+// How a face's image is turned to match its panel's mounting: rotated
+// clockwise by rotation degrees (0, 90, 180 or 270), then flipped
+// left-right (mirrorX) and/or top-bottom (mirrorY)
+struct FaceOrientation {
+    int rotation = 0;
+    bool mirrorX = false;
+    bool mirrorY = false;
+};
+
+// Maps panel pixels back to cube pixels. The chain layout and the face
+// orientations compile into one flat LUT holding, for every panel pixel in
+// scan order, the MatrixBuffer index it shows, so the encoder gathers each
+// panel row with one linear walk instead of transforming coordinates.
+//
+// Configuration files are line based; '#' starts a comment:
+//
+//   chains 2                              # faces dealt round-robin
+//   face 3 chain 1 position 0 rotate 90 mirror x
+//
+// "chains" resets every face to ChainLayout::interleaved, so it must come
+// before any "face" line; each "face" line then sets that face's slot and, optionally, rotation and mirroring
+// (mirror x, y or xy).
+class PixelMapper {
+public:
+    // Identity orientation on a single chain
+    PixelMapper();
+    explicit PixelMapper(const ChainLayout& layout);
+
+    // Both throw std::invalid_argument for an invalid layout or rotation
+    void setLayout(const ChainLayout& layout);
+    const ChainLayout& getLayout() const { return layout; }
+    void setOrientation(int face, const FaceOrientation& orientation);
+    const FaceOrientation& getOrientation(int face) const { return orientations[face]; }
+
+    // Throw std::runtime_error naming the offending line
+    static PixelMapper parse(std::istream& input, const std::string& sourceName = "mapping");
+    static PixelMapper loadFromFile(const std::string& path);
+
+    // CUBE_SIZE buffer indices shown by one panel row of a face, left to
+    // right, for a buffer in the given layout
+    const uint16_t* getRowSources(int face, int panelY, BufferLayout bufferLayout = BufferLayout::FaceMajor) const {
+        size_t table = bufferLayout == BufferLayout::ScanOrder ? TOTAL_LEDS : 0;
+        return lut.data() + table + face * (CUBE_SIZE * CUBE_SIZE) + panelY * CUBE_SIZE;
+    }
+
+    // True when panels show the faces as stored in BufferLayout::ScanOrder:
+    // one chain, face k at position k, no rotation or mirroring
+    bool isScanNative() const;
+
+    // Panel rows of a face that show any of the given buffer rows
+    uint64_t getPanelRows(int face, uint64_t bufferRows) const;
+
+    // Buffer coordinates shown at a panel pixel of a face
+    void panelToFace(int face, int panelX, int panelY, int& x, int& y) const;
+
+private:
+    ChainLayout layout;
+    std::array<FaceOrientation, CUBE_DEPTH> orientations;
+
+    std::vector<uint16_t> lut;                                        // Per BufferLayout: TOTAL_LEDS by face, panel row, column
+    std::array<std::array<uint64_t, CUBE_SIZE>, CUBE_DEPTH> panelRows;  // Panel rows showing each buffer row
+
+    void compile(int face);
+};
+
+} // namespace LEDCube
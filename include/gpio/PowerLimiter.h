@@ -0,0 +1,72 @@
+#pragma once
+
+#include "ColorLUT.h"
+#include "../core/MatrixBuffer.h"
+#include <array>
+#include <cstdint>
+
+namespace LEDCube {
+
+// Supply budget for the panels and the current model behind it
+struct PowerBudget {
+    double maxAmps = 0.0;            // 0 disables limiting
+    double panelFullWhiteAmps = 4.0; // One panel with every LED at full white
+    double panelIdleAmps = 0.2;      // One dark panel
+    double releaseStep = 0.02;       // Largest brightness increase per frame
+
+    bool operator==(const PowerBudget& other) const {
+        return maxAmps == other.maxAmps && panelFullWhiteAmps == other.panelFullWhiteAmps &&
+               panelIdleAmps == other.panelIdleAmps && releaseStep == other.releaseStep;
+    }
+    bool operator!=(const PowerBudget& other) const { return !(*this == other); }
+};
+
+struct PowerStats {
+    double requestedAmps = 0.0; // Estimated draw at the requested brightness
+    double outputAmps = 0.0;    // Estimated draw at the brightness output
+    double scale = 1.0;         // Output / requested brightness
+    bool limiting = false;
+};
+
+// Automatic brightness limiter. The draw of a frame is estimated from the
+// sum of its channels' BCM levels (after gamma, white balance and
+// calibration), which scales linearly with brightness. Sums are kept per
+// face row and only dirty rows are re-summed, so a frame costs a few
+// hundred lookups unless it changed everywhere.
+//
+// Brightness drops at once when a frame would exceed the budget and
+// recovers by releaseStep per frame, in steps of 1/256.
+//
+// Used by the thread that presents frames only.
+class PowerLimiter {
+public:
+    PowerLimiter();
+
+    void setBudget(const PowerBudget& budget);
+    const PowerBudget& getBudget() const { return budget; }
+    bool isEnabled() const { return budget.maxAmps > 0.0; }
+
+    // Color correction the levels are estimated with; brightness is ignored
+    void setColorSettings(const ColorSettings& settings);
+
+    // Re-sums the buffer's dirty rows, or all rows when full is set
+    void update(const MatrixBuffer& buffer, bool full);
+
+    // Brightness to output for the requested one under the budget
+    double limit(double requestedBrightness);
+
+    const PowerStats& getStats() const { return stats; }
+
+private:
+    PowerBudget budget;
+    ColorLUT levels;  // At brightness 1.0 and the full bit depth
+    std::array<std::array<std::array<uint32_t, 3>, CUBE_SIZE>, CUBE_DEPTH> rowSums;
+    uint64_t totalLevels;
+    bool sumsValid;
+    double output;    // Last brightness returned by limit()
+    PowerStats stats;
+
+    void sumRow(const MatrixBuffer& buffer, int face, int y);
+};
+
+} // namespace LEDCube
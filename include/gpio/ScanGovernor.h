@@ -0,0 +1,72 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace LEDCube {
+
+// Constraints for choosing the BCM bit depth and refresh rate
+struct ScanGovernorOptions {
+    bool enabled = false;
+    int minRefreshRate = 200;   // Hz; below this cameras pick up flicker
+    int maxRefreshRate = 400;   // Hz; spare capacity beyond it is left idle
+    int minBitDepth = 8;
+    int maxBitDepth = 11;
+    double headroom = 0.85;     // Fraction of the measured capacity to plan with
+    double upgradeMargin = 1.1; // A deeper setting must beat the minimum by this factor
+    std::chrono::milliseconds interval{1000}; // Re-tuning period
+};
+
+// Operating point chosen by ScanGovernor, with the measurement behind it
+struct ScanOperatingPoint {
+    int bitDepth = 0;
+    int refreshRate = 0;          // Hz, as paced by the display thread
+    double capacity = 0.0;        // Hz the scan could reach at bitDepth, busy all the time
+    double shiftNsPerPlane = 0.0; // Measured cost of shifting and latching one row's plane
+    double load = 0.0;            // refreshRate / capacity
+    bool meetsMinimum = false;    // False when even minBitDepth cannot reach minRefreshRate
+    uint64_t samples = 0;         // Row pairs measured for this choice
+    uint64_t retunes = 0;         // Bit depth changes so far
+};
+
+// Trades BCM bit depth against refresh rate from measured scan throughput.
+//
+// A row pair takes bitDepth * shift + base * (2^bitDepth - 1): every plane
+// shifts the chain once (the cost measured here, which grows with GPIO speed
+// limits and CPU contention) and is held for its weight. The governor picks
+// the deepest setting whose refresh capacity, scaled by headroom, reaches
+// minRefreshRate, then paces at that capacity up to maxRefreshRate. Depth is
+// lowered as soon as capacity drops, but raised only with upgradeMargin to
+// spare so it does not flap.
+//
+// Used by the display thread only.
+class ScanGovernor {
+public:
+    explicit ScanGovernor(const ScanGovernorOptions& options = ScanGovernorOptions());
+
+    void setOptions(const ScanGovernorOptions& options);
+    const ScanGovernorOptions& getOptions() const { return options; }
+    bool isEnabled() const { return options.enabled; }
+
+    // Adds one scanned row pair, timed from its first shift to the end of
+    // its last plane
+    void recordRowPair(std::chrono::nanoseconds duration, int bitDepth, unsigned int baseTimeNs);
+    uint64_t getSampleCount() const { return rowPairs; }
+
+    // Chooses an operating point from the row pairs recorded since the last
+    // call, which are then discarded. Without samples the current point is kept.
+    ScanOperatingPoint update(int currentBitDepth, unsigned int baseTimeNs);
+    const ScanOperatingPoint& getOperatingPoint() const { return point; }
+
+    // Full refreshes per second a setting allows when scanning back to back
+    static double refreshCapacity(int bitDepth, unsigned int baseTimeNs, double shiftNsPerPlane);
+
+private:
+    ScanGovernorOptions options;
+    ScanOperatingPoint point;
+    double shiftNs;   // Sum of per-row shift time
+    uint64_t planes;  // Planes behind shiftNs
+    uint64_t rowPairs;
+};
+
+} // namespace LEDCube
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Shader.h"
 #include "../core/LEDCube.h"
 #include <GL/glew.h>
 #include <glm/glm.hpp>
@@ -14,13 +15,32 @@ public:
     void shutdown();
     void renderCube(const LEDCube& cube, const glm::mat4& viewProj, const glm::mat4& model);
     void setCubeScale(float scale);
+
+    // CPU time spent staging and submitting the last texture upload
+    double getLastUploadTimeMs() const { return lastUploadTimeMs; }
+    bool usesPersistentMapping() const { return persistentMapping; }
 private:
     void updateTextures(const LEDCube& cube);
-    
-    GLuint cubeVAO, cubeVBO, cubeEBO, cubeShader;
-    GLuint faceTextures[6];  // One texture per cube face
+    void createUploadBuffers();
+
+    static constexpr int UPLOAD_BUFFER_COUNT = 2;
+    static constexpr GLsizeiptr FRAME_BYTES = TOTAL_LEDS * 3;
+
+    GLuint cubeVAO, cubeVBO, cubeEBO;
+    Shader cubeShader;
+    GLint viewProjLocation, modelLocation;
+    GLuint faceTextureArray;  // One layer per cube face
+
+    // Double-buffered pixel unpack buffers, persistently mapped when supported
+    GLuint uploadBuffers[UPLOAD_BUFFER_COUNT];
+    uint8_t* mappedUploads[UPLOAD_BUFFER_COUNT];
+    GLsync uploadFences[UPLOAD_BUFFER_COUNT];
+    int uploadIndex;
+    bool persistentMapping;
+    double lastUploadTimeMs;
+
     bool initialized;
     float cubeScale;
 };
 
-} // namespace LEDCube 
\ No newline at end of file
+} // namespace LEDCube
@@ -20,6 +20,9 @@ public:
     void shutdown();
     bool isInitialized() const { return initialized; }
     
+    // Create a hidden window (call before initialize), e.g. for Mesa llvmpipe runs
+    void setOffscreen(bool enabled) { offscreen = enabled; }
+    
     // Window management
     void setWindowSize(int width, int height);
     void setWindowTitle(const std::string& title);
@@ -50,7 +53,9 @@ public:
     // Utility
     void takeScreenshot(const std::string& filename);
     void setVSync(bool enabled);
+    int getRefreshRate() const; // Of the window's monitor (or the primary one) in Hz; 0 if unknown
     void setCubeRotationCallback(std::function<void(float, float)> cb) { rotationCallback = std::move(cb); }
+    double getLastUploadTimeMs() const { return cubeRenderer ? cubeRenderer->getLastUploadTimeMs() : 0.0; }
 
 private:
     GLFWwindow* window;
@@ -73,6 +78,7 @@ private:
     bool wireframeMode;
     bool showAxes;
     bool vsyncEnabled;
+    bool offscreen = false;
     
     // Input settings
     float mouseSensitivity;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <unordered_map>
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 
@@ -27,18 +28,26 @@ public:
     void setMat3(const std::string& name, const glm::mat3& value);
     void setMat4(const std::string& name, const glm::mat4& value);
     
+    // Uniform locations, resolved once and cached per name
+    GLint getUniformLocation(const std::string& name);
+    
+    // Uniform setters for pre-resolved locations (no lookup on the hot path)
+    void setInt(GLint location, int value);
+    void setFloat(GLint location, float value);
+    void setMat4(GLint location, const glm::mat4& value);
+    
     // Utility
     bool isValid() const { return programID != 0; }
     GLuint getProgramID() const { return programID; }
 
 private:
     GLuint programID;
+    std::unordered_map<std::string, GLint> uniformLocations;
     
     // Helper methods
     bool compileShader(GLuint& shaderID, GLenum type, const std::string& source);
     bool linkProgram();
-    void checkCompileErrors(GLuint shader, const std::string& type);
-    GLint getUniformLocation(const std::string& name);
+    bool checkCompileErrors(GLuint shader, const std::string& type);
 };
 
 } // namespace LEDCube 
\ No newline at end of file
@@ -1,4 +1,6 @@
 #include "core/Animation.h"
+#include "core/CubeTopology.h"
+#include "core/JobSystem.h"
 #include <cmath>
 #include <random>
 #include <algorithm>
@@ -42,8 +44,7 @@ bool FunctionAnimation::isFinished() const {
 }
 
 // RainAnimation implementation
-RainAnimation::RainAnimation() {
-    drops.reserve(50); // Pre-allocate space for drops
+RainAnimation::RainAnimation() : drops(MAX_DROPS) {
 }
 
 void RainAnimation::init() {
@@ -69,6 +70,17 @@ void RainAnimation::setGravityDirection(float pitch, float yaw) {
         gravityY /= length;
         gravityZ /= length;
     }
+    
+    // Re-aim drops already in flight, keeping their speed
+    float* vx = drops.velocityX();
+    float* vy = drops.velocityY();
+    float* vz = drops.velocityZ();
+    for (size_t i = 0; i < drops.size(); ++i) {
+        float speed = std::sqrt(vx[i] * vx[i] + vy[i] * vy[i] + vz[i] * vz[i]);
+        vx[i] = gravityX * speed;
+        vy[i] = gravityY * speed;
+        vz[i] = gravityZ * speed;
+    }
 }
 
 void RainAnimation::update(double deltaTime) {
@@ -82,67 +94,43 @@ void RainAnimation::update(double deltaTime) {
         static std::random_device rd;
         static std::mt19937 gen(rd());
         static std::uniform_real_distribution<float> posDist(0, CUBE_SIZE - 1);
+        static std::uniform_real_distribution<float> depthDist(0, CUBE_DEPTH - 1);
         static std::uniform_real_distribution<float> speedDist(20.0f, 50.0f);
         static std::uniform_real_distribution<float> colorDist(0.0f, 1.0f);
         
-        RainDrop drop;
+        float x, y, z;
         
         // Spawn drops at the "top" face based on gravity direction
         if (std::abs(gravityY) > std::abs(gravityX) && std::abs(gravityY) > std::abs(gravityZ)) {
-            // Gravity mostly Y direction
-            if (gravityY > 0) {
-                // Gravity pointing up, spawn at bottom
-                drop.pos = Position(static_cast<int>(posDist(gen)), 0, static_cast<int>(posDist(gen)));
-            } else {
-                // Gravity pointing down, spawn at top
-                drop.pos = Position(static_cast<int>(posDist(gen)), CUBE_SIZE - 1, static_cast<int>(posDist(gen)));
-            }
+            // Gravity mostly Y direction: spawn at bottom when pointing up, top when pointing down
+            x = posDist(gen);
+            y = gravityY > 0 ? 0.0f : CUBE_SIZE - 1;
+            z = depthDist(gen);
         } else if (std::abs(gravityX) > std::abs(gravityZ)) {
-            // Gravity mostly X direction
-            if (gravityX > 0) {
-                // Gravity pointing right, spawn at left
-                drop.pos = Position(0, static_cast<int>(posDist(gen)), static_cast<int>(posDist(gen)));
-            } else {
-                // Gravity pointing left, spawn at right
-                drop.pos = Position(CUBE_SIZE - 1, static_cast<int>(posDist(gen)), static_cast<int>(posDist(gen)));
-            }
+            // Gravity mostly X direction: spawn at left when pointing right, right when pointing left
+            x = gravityX > 0 ? 0.0f : CUBE_SIZE - 1;
+            y = posDist(gen);
+            z = depthDist(gen);
         } else {
-            // Gravity mostly Z direction
-            if (gravityZ > 0) {
-                // Gravity pointing forward, spawn at back
-                drop.pos = Position(static_cast<int>(posDist(gen)), static_cast<int>(posDist(gen)), 0);
-            } else {
-                // Gravity pointing back, spawn at front
-                drop.pos = Position(static_cast<int>(posDist(gen)), static_cast<int>(posDist(gen)), CUBE_DEPTH - 1);
-            }
+            // Gravity mostly Z direction: spawn at back when pointing forward, front when pointing back
+            x = posDist(gen);
+            y = posDist(gen);
+            z = gravityZ > 0 ? 0.0f : CUBE_DEPTH - 1;
         }
         
-        drop.speed = speedDist(gen);
-        drop.color = Color(
+        float speed = speedDist(gen);
+        Color color(
             static_cast<uint8_t>(colorDist(gen) * 255),
             static_cast<uint8_t>(colorDist(gen) * 255),
             static_cast<uint8_t>(colorDist(gen) * 255)
         );
         
-        drops.push_back(drop);
+        drops.spawn(x, y, z, gravityX * speed, gravityY * speed, gravityZ * speed, color);
     }
     
-    // Update existing drops based on gravity direction
-    for (auto it = drops.begin(); it != drops.end();) {
-        // Move drops in gravity direction
-        it->pos.x += gravityX * it->speed * deltaTime * animationSpeed;
-        it->pos.y += gravityY * it->speed * deltaTime * animationSpeed;
-        it->pos.z += gravityZ * it->speed * deltaTime * animationSpeed;
-        
-        // Remove drops that are outside the cube
-        if (it->pos.x < 0 || it->pos.x >= CUBE_SIZE ||
-            it->pos.y < 0 || it->pos.y >= CUBE_SIZE ||
-            it->pos.z < 0 || it->pos.z >= CUBE_DEPTH) {
-            it = drops.erase(it);
-        } else {
-            ++it;
-        }
-    }
+    // Move drops along their velocity and remove drops that left the cube
+    drops.integrate(static_cast<float>(deltaTime * animationSpeed));
+    drops.removeDead();
 }
 
 void RainAnimation::render(LEDCube& cube) {
@@ -150,11 +138,7 @@ void RainAnimation::render(LEDCube& cube) {
     cube.clear();
     
     // Render drops
-    for (const auto& drop : drops) {
-        if (drop.pos.isValid()) {
-            cube.setLED(drop.pos, drop.color);
-        }
-    }
+    drops.rasterize(cube);
 }
 
 void RainAnimation::reset() {
@@ -163,110 +147,133 @@ void RainAnimation::reset() {
     currentTime = 0.0;
 }
 
-// WaveAnimation implementation
-WaveAnimation::WaveAnimation() {
+// PixelShaderAnimation implementation
+void PixelShaderAnimation::init() {
+    currentTime = 0.0;
 }
 
-void WaveAnimation::init() {
-    waveTime = 0.0;
+void PixelShaderAnimation::update(double deltaTime) {
+    currentTime += deltaTime * animationSpeed;
 }
 
-void WaveAnimation::update(double deltaTime) {
-    waveTime += deltaTime * animationSpeed;
+void PixelShaderAnimation::render(LEDCube& cube) {
+    prepare(currentTime);
+    
+    JobSystem& jobs = jobSystem ? *jobSystem : JobSystem::shared();
+    jobs.parallelFor(TILE_COUNT, 1, [&](int begin, int end) {
+        for (int tile = begin; tile < end; ++tile) {
+            shadeTile(cube, tile);
+        }
+    });
+    
+    // Every row is rewritten; only the dirty tracking is left to merge
+    for (int tile = 0; tile < TILE_COUNT; ++tile) {
+        int face = tile / TILES_PER_FACE;
+        int firstRow = (tile % TILES_PER_FACE) * ROWS_PER_TILE;
+        uint64_t written = ((uint64_t(1) << ROWS_PER_TILE) - 1) << firstRow;
+        cube.commitRows(face, written, tileRows[tile].changed, tileRows[tile].lit);
+    }
 }
 
-void WaveAnimation::render(LEDCube& cube) {
-    cube.clear();
+void PixelShaderAnimation::shadeTile(LEDCube& cube, int tile) {
+    const CubeTopology& topology = CubeTopology::instance();
+    int face = tile / TILES_PER_FACE;
+    int firstRow = (tile % TILES_PER_FACE) * ROWS_PER_TILE;
     
-    for (int x = 0; x < CUBE_SIZE; ++x) {
-        for (int y = 0; y < CUBE_SIZE; ++y) {
-            for (int z = 0; z < CUBE_DEPTH; ++z) {
-                // Create a wave pattern
-                float wave = std::sin(waveTime + x * 0.2f + y * 0.1f + z * 0.3f);
-                float intensity = (wave + 1.0f) * 0.5f;
-                
-                Color color(
-                    static_cast<uint8_t>(waveColor.r * intensity),
-                    static_cast<uint8_t>(waveColor.g * intensity),
-                    static_cast<uint8_t>(waveColor.b * intensity)
-                );
-                
-                cube.setLED(Position(x, y, z), color);
-            }
+    PixelInput pixel;
+    pixel.face = face;
+    pixel.time = currentTime;
+    uint64_t changed = 0;
+    uint64_t lit = 0;
+    
+    for (int y = firstRow; y < firstRow + ROWS_PER_TILE; ++y) {
+        Color* row = cube.getRow(face, y);
+        int index = face * CubeTopology::FACE_PIXELS + y * CUBE_SIZE;
+        pixel.y = y;
+        pixel.v = (y + 0.5f) / CUBE_SIZE;
+        
+        bool rowChanged = false;
+        bool rowLit = false;
+        for (int x = 0; x < CUBE_SIZE; ++x) {
+            pixel.x = x;
+            pixel.u = (x + 0.5f) / CUBE_SIZE;
+            pixel.position = topology.getPosition(index + x);
+            
+            Color color = shade(pixel);
+            rowChanged |= row[x] != color;
+            rowLit |= color != Color::Black();
+            row[x] = color;
         }
+        
+        uint64_t rowBit = uint64_t(1) << y;
+        changed |= rowChanged ? rowBit : 0;
+        lit |= rowLit ? rowBit : 0;
     }
+    
+    tileRows[tile] = {changed, lit};
 }
 
-void WaveAnimation::reset() {
-    waveTime = 0.0;
+void PixelShaderAnimation::reset() {
     currentTime = 0.0;
 }
 
-// CubeRotationAnimation implementation
-CubeRotationAnimation::CubeRotationAnimation() {
+// WaveAnimation implementation
+WaveAnimation::WaveAnimation() {
 }
 
-void CubeRotationAnimation::init() {
-    rotationX = 0.0;
-    rotationY = 0.0;
-    rotationZ = 0.0;
+Color WaveAnimation::shade(const PixelInput& pixel) const {
+    // Create a wave pattern
+    float wave = std::sin(pixel.time + pixel.x * 0.2f + pixel.y * 0.1f + pixel.face * 0.3f);
+    float intensity = (wave + 1.0f) * 0.5f;
+    
+    return Color(
+        static_cast<uint8_t>(waveColor.r * intensity),
+        static_cast<uint8_t>(waveColor.g * intensity),
+        static_cast<uint8_t>(waveColor.b * intensity)
+    );
 }
 
-void CubeRotationAnimation::update(double deltaTime) {
-    currentTime += deltaTime * animationSpeed;
-    
-    rotationX += deltaTime * 0.5f * animationSpeed;
-    rotationY += deltaTime * 0.3f * animationSpeed;
-    rotationZ += deltaTime * 0.2f * animationSpeed;
+// CubeRotationAnimation implementation
+CubeRotationAnimation::CubeRotationAnimation() {
 }
 
-void CubeRotationAnimation::render(LEDCube& cube) {
-    cube.clear();
+void CubeRotationAnimation::prepare(double time) {
+    // Rotate about x, then y, then z, each at its own rate
+    double ax = time * 0.5;
+    double ay = time * 0.3;
+    double az = time * 0.2;
+    float cx = std::cos(ax), sx = std::sin(ax);
+    float cy = std::cos(ay), sy = std::sin(ay);
+    float cz = std::cos(az), sz = std::sin(az);
     
-    // Create a rotating cube pattern
-    for (int x = 0; x < CUBE_SIZE; ++x) {
-        for (int y = 0; y < CUBE_SIZE; ++y) {
-            for (int z = 0; z < CUBE_DEPTH; ++z) {
-                // Apply rotation transformation
-                float rx = x * std::cos(rotationY) - z * std::sin(rotationY);
-                float ry = y * std::cos(rotationX) - z * std::sin(rotationX);
-                float rz = z * std::cos(rotationZ) + x * std::sin(rotationZ);
-                
-                // Map to cube coordinates
-                int px = static_cast<int>((rx + CUBE_SIZE/2) * CUBE_SIZE / (CUBE_SIZE * 1.5f));
-                int py = static_cast<int>((ry + CUBE_SIZE/2) * CUBE_SIZE / (CUBE_SIZE * 1.5f));
-                int pz = static_cast<int>((rz + CUBE_DEPTH/2) * CUBE_DEPTH / (CUBE_DEPTH * 1.5f));
-                
-                if (px >= 0 && px < CUBE_SIZE && 
-                    py >= 0 && py < CUBE_SIZE && 
-                    pz >= 0 && pz < CUBE_DEPTH) {
-                    
-                    // Create color based on position and time
-                    Color color(
-                        static_cast<uint8_t>((px * 255) / CUBE_SIZE),
-                        static_cast<uint8_t>((py * 255) / CUBE_SIZE),
-                        static_cast<uint8_t>((pz * 255) / CUBE_DEPTH)
-                    );
-                    
-                    cube.setLED(Position(px, py, pz), color);
-                }
-            }
-        }
-    }
+    rotation = {
+        cz * cy, cz * sy * sx - sz * cx, cz * sy * cx + sz * sx,
+        sz * cy, sz * sy * sx + cz * cx, sz * sy * cx - cz * sx,
+        -sy,     cy * sx,                cy * cx
+    };
 }
 
-void CubeRotationAnimation::reset() {
-    rotationX = 0.0;
-    rotationY = 0.0;
-    rotationZ = 0.0;
-    currentTime = 0.0;
+Color CubeRotationAnimation::shade(const PixelInput& pixel) const {
+    // An RGB gradient cube turning inside the surface: each pixel shows the
+    // colour of its rotated position
+    const auto& p = pixel.position;
+    float rx = rotation[0] * p.x + rotation[1] * p.y + rotation[2] * p.z;
+    float ry = rotation[3] * p.x + rotation[4] * p.y + rotation[5] * p.z;
+    float rz = rotation[6] * p.x + rotation[7] * p.y + rotation[8] * p.z;
+    
+    // Rotated corners reach sqrt(3); scale that range onto 0..255
+    constexpr float SCALE = 255.0f / (2.0f * 1.7320508f);
+    return Color(
+        static_cast<uint8_t>((rx + 1.7320508f) * SCALE),
+        static_cast<uint8_t>((ry + 1.7320508f) * SCALE),
+        static_cast<uint8_t>((rz + 1.7320508f) * SCALE)
+    );
 }
 
 // GameOfLifeAnimation implementation
 GameOfLifeAnimation::GameOfLifeAnimation() {
-    // Initialize grids for 64x384 panel
-    currentGrid.resize(64, std::vector<bool>(384, false));
-    nextGrid.resize(64, std::vector<bool>(384, false));
+    currentGrid.resize(GRID_HEIGHT, 0);
+    nextGrid.resize(GRID_HEIGHT, 0);
 }
 
 void GameOfLifeAnimation::init() {
@@ -288,18 +295,18 @@ void GameOfLifeAnimation::update(double deltaTime) {
 void GameOfLifeAnimation::render(LEDCube& cube) {
     cube.clear();
     
-    // Render the 2D grid to the cube
-    for (int x = 0; x < 64; ++x) {
-        for (int y = 0; y < 384; ++y) {
-            if (currentGrid[x][y]) {
-                // Map 2D coordinates to cube position
-                // Each face is 64x64, so we need to map the 384 height to 6 faces
-                int face = y / 64;
-                int faceY = y % 64;
-                
-                Position pos(x, faceY, face);
-                cube.setLED(pos, Color::Green()); // Living cells are green
-            }
+    // Render the grid to the cube, visiting only the living cells
+    for (int y = 0; y < GRID_HEIGHT; ++y) {
+        uint64_t row = currentGrid[y];
+        int face = y / CUBE_SIZE;
+        int faceY = y % CUBE_SIZE;
+        
+        while (row != 0) {
+            int x = __builtin_ctzll(row);
+            row &= row - 1;
+            
+            Position pos(x, faceY, face);
+            cube.setLED(pos, Color::Green()); // Living cells are green
         }
     }
 }
@@ -316,68 +323,106 @@ void GameOfLifeAnimation::initializeRandom() {
     static std::uniform_real_distribution<float> dist(0.0f, 1.0f);
     
     // Initialize with random pattern (about 30% alive)
-    for (int x = 0; x < 64; ++x) {
-        for (int y = 0; y < 384; ++y) {
-            currentGrid[x][y] = (dist(gen) < 0.3f);
+    for (int y = 0; y < GRID_HEIGHT; ++y) {
+        uint64_t row = 0;
+        for (int x = 0; x < GRID_WIDTH; ++x) {
+            if (dist(gen) < 0.3f) {
+                row |= uint64_t(1) << x;
+            }
         }
+        currentGrid[y] = row;
     }
 }
 
-void GameOfLifeAnimation::updateGameOfLife() {
-    // Compute next generation
-    for (int x = 0; x < 64; ++x) {
-        for (int y = 0; y < 384; ++y) {
-            int neighbors = countNeighbors(x, y);
-            bool current = currentGrid[x][y];
-            
-            // Conway's Game of Life rules
-            bool next = false;
-            if (current) {
-                // Survive with 2 or 3 neighbors
-                next = (neighbors == 2 || neighbors == 3);
-            } else {
-                // Born with exactly 3 neighbors
-                next = (neighbors == 3);
-            }
-            
-            nextGrid[x][y] = next;
+uint64_t GameOfLifeAnimation::nextRow(uint64_t above, uint64_t row, uint64_t below, unsigned left, unsigned right) {
+    // Horizontal neighbours shift in the halo cells beside each row; bit 0
+    // of left and right belongs to the row above, bit 2 to the row below
+    uint64_t aboveLeft  = (above << 1) | (left & 1);
+    uint64_t aboveRight = (above >> 1) | (uint64_t(right & 1) << 63);
+    uint64_t rowLeft    = (row << 1) | ((left >> 1) & 1);
+    uint64_t rowRight   = (row >> 1) | (uint64_t((right >> 1) & 1) << 63);
+    uint64_t belowLeft  = (below << 1) | (left >> 2);
+    uint64_t belowRight = (below >> 1) | (uint64_t(right >> 2) << 63);
+    
+    // Bit-sliced neighbour count for all 64 cells at once.
+    // Each full adder reduces three one-bit inputs to a sum and a carry bit.
+    uint64_t aboveSum   = aboveLeft ^ above ^ aboveRight;
+    uint64_t aboveCarry = (aboveLeft & above) | (aboveRight & (aboveLeft ^ above));
+    uint64_t belowSum   = belowLeft ^ below ^ belowRight;
+    uint64_t belowCarry = (belowLeft & below) | (belowRight & (belowLeft ^ below));
+    uint64_t rowSum     = rowLeft ^ rowRight;
+    uint64_t rowCarry   = rowLeft & rowRight;
+    
+    // Weight-1 column
+    uint64_t ones      = aboveSum ^ belowSum ^ rowSum;
+    uint64_t onesCarry = (aboveSum & belowSum) | (rowSum & (aboveSum ^ belowSum));
+    
+    // Weight-2 column (four inputs); eight neighbours wrap to zero, which still dies
+    uint64_t twosPartial = aboveCarry ^ belowCarry ^ rowCarry;
+    uint64_t twosCarry   = (aboveCarry & belowCarry) | (rowCarry & (aboveCarry ^ belowCarry));
+    uint64_t twos        = twosPartial ^ onesCarry;
+    uint64_t fours       = twosCarry ^ (twosPartial & onesCarry);
+    
+    // Conway's Game of Life rules:
+    // born with exactly 3 neighbors, survive with 2 or 3 neighbors
+    return ~fours & twos & (ones | row);
+}
+
+void GameOfLifeAnimation::gatherHalos() {
+    // Grid row = face-major index / 64, so a surface index addresses its cell directly
+    const CubeTopology& topology = CubeTopology::instance();
+    auto cell = [this](uint16_t index) {
+        return static_cast<uint8_t>((currentGrid[index / GRID_WIDTH] >> (index % GRID_WIDTH)) & 1);
+    };
+    
+    for (int face = 0; face < CUBE_DEPTH; ++face) {
+        const auto& border = topology.getHaloBorder(face);
+        FaceHalo& halo = halos[face];
+        halo.above = 0;
+        halo.below = 0;
+        for (int i = 0; i < CUBE_SIZE; ++i) {
+            halo.above |= uint64_t(cell(border[i].source)) << i;
+            halo.below |= uint64_t(cell(border[CUBE_SIZE + i].source)) << i;
+            halo.left[i + 1] = cell(border[2 * CUBE_SIZE + i].source);
+            halo.right[i + 1] = cell(border[3 * CUBE_SIZE + i].source);
         }
     }
-    
-    // Swap grids
-    currentGrid.swap(nextGrid);
 }
 
-int GameOfLifeAnimation::countNeighbors(int x, int y) {
-    int count = 0;
+void GameOfLifeAnimation::updateGameOfLife() {
+    gatherHalos();
     
-    // Check all 8 neighbors with wrapping
-    for (int dx = -1; dx <= 1; ++dx) {
-        for (int dy = -1; dy <= 1; ++dy) {
-            if (dx == 0 && dy == 0) continue; // Skip self
-            
-            int nx = (x + dx + 64) % 64;  // Wrap X
-            int ny = (y + dy + 384) % 384; // Wrap Y
-            
-            if (getCell(nx, ny)) {
-                count++;
-            }
+    // Each face steps on its own; rows beyond its edges come from the halo
+    for (int face = 0; face < CUBE_DEPTH; ++face) {
+        const uint64_t* current = currentGrid.data() + face * CUBE_SIZE;
+        uint64_t* next = nextGrid.data() + face * CUBE_SIZE;
+        const FaceHalo& halo = halos[face];
+        
+        for (int y = 0; y < CUBE_SIZE; ++y) {
+            uint64_t above = y > 0 ? current[y - 1] : halo.above;
+            uint64_t below = y < CUBE_SIZE - 1 ? current[y + 1] : halo.below;
+            // Halo entries y..y+2 are the rows y-1..y+1
+            unsigned left = halo.left[y] | (halo.left[y + 1] << 1) | (halo.left[y + 2] << 2);
+            unsigned right = halo.right[y] | (halo.right[y + 1] << 1) | (halo.right[y + 2] << 2);
+            next[y] = nextRow(above, current[y], below, left, right);
         }
     }
     
-    return count;
+    // Swap grids
+    currentGrid.swap(nextGrid);
 }
 
 bool GameOfLifeAnimation::getCell(int x, int y) {
-    if (x >= 0 && x < 64 && y >= 0 && y < 384) {
-        return currentGrid[x][y];
+    if (x >= 0 && x < GRID_WIDTH && y >= 0 && y < GRID_HEIGHT) {
+        return (currentGrid[y] >> x) & 1;
     }
     return false;
 }
 
 void GameOfLifeAnimation::setCell(int x, int y, bool alive) {
-    if (x >= 0 && x < 64 && y >= 0 && y < 384) {
-        currentGrid[x][y] = alive;
+    if (x >= 0 && x < GRID_WIDTH && y >= 0 && y < GRID_HEIGHT) {
+        uint64_t bit = uint64_t(1) << x;
+        currentGrid[y] = alive ? (currentGrid[y] | bit) : (currentGrid[y] & ~bit);
     }
 }
 
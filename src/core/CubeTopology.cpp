@@ -0,0 +1,126 @@
+#include "core/CubeTopology.h"
+
+namespace LEDCube {
+
+namespace {
+
+// Where a face sits on the cube, in lattice coordinates where the cube's
+// pixels span 0..CUBE_SIZE-1 on each axis and a face lies one step outside
+// them (-1 or CUBE_SIZE) along its normal. Matches the vertex table in
+// CubeRenderer.
+struct FaceFrame {
+    int normalAxis, normalSign;
+    int uAxis, uSign; // Face x runs along this axis
+    int vAxis, vSign; // Face y runs along this axis
+};
+
+constexpr int X = 0, Y = 1, Z = 2;
+
+constexpr std::array<FaceFrame, CUBE_DEPTH> FRAMES = {{
+    {Z, +1, X, +1, Y, +1}, // Front
+    {Z, -1, X, -1, Y, +1}, // Back
+    {X, -1, Z, +1, Y, -1}, // Left
+    {X, +1, Z, -1, Y, -1}, // Right
+    {Y, +1, X, +1, Z, -1}, // Top
+    {Y, -1, X, -1, Z, -1}, // Bottom
+}};
+
+constexpr int LAST = CUBE_SIZE - 1;
+
+int toLattice(int sign, int coordinate) {
+    return sign > 0 ? coordinate : LAST - coordinate;
+}
+
+bool inside(int coordinate) {
+    return coordinate >= 0 && coordinate <= LAST;
+}
+
+int faceAt(int axis, int sign) {
+    for (int face = 0; face < CUBE_DEPTH; ++face) {
+        if (FRAMES[face].normalAxis == axis && FRAMES[face].normalSign == sign) {
+            return face;
+        }
+    }
+    return -1;
+}
+
+} // namespace
+
+const CubeTopology& CubeTopology::instance() {
+    static const CubeTopology topology;
+    return topology;
+}
+
+int CubeTopology::resolve(int face, int x, int y) {
+    bool xInside = inside(x);
+    bool yInside = inside(y);
+    if (xInside && yInside) {
+        return face * FACE_PIXELS + y * CUBE_SIZE + x;
+    }
+    if (!xInside && !yInside) {
+        return NO_NEIGHBOR;
+    }
+
+    // Off one edge: the point lies beside the neighbouring face. Pulling it
+    // back inside along this face's normal lands on that face.
+    const FaceFrame& frame = FRAMES[face];
+    std::array<int, 3> point;
+    point[frame.normalAxis] = frame.normalSign > 0 ? LAST : 0;
+    point[frame.uAxis] = toLattice(frame.uSign, x);
+    point[frame.vAxis] = toLattice(frame.vSign, y);
+
+    int axis = xInside ? frame.vAxis : frame.uAxis;
+    int next = faceAt(axis, point[axis] > LAST ? +1 : -1);
+    const FaceFrame& nextFrame = FRAMES[next];
+    int nextX = toLattice(nextFrame.uSign, point[nextFrame.uAxis]);
+    int nextY = toLattice(nextFrame.vSign, point[nextFrame.vAxis]);
+    return next * FACE_PIXELS + nextY * CUBE_SIZE + nextX;
+}
+
+CubeTopology::CubeTopology()
+    : neighbors4(TOTAL_LEDS * NEIGHBORS_4), neighbors8(TOTAL_LEDS * NEIGHBORS_8), positions(TOTAL_LEDS) {
+    // Lattice coordinate to -1..1; the face planes at -1 and CUBE_SIZE map to -1 and 1
+    auto toSpace = [](int coordinate) {
+        if (coordinate < 0 || coordinate > LAST) {
+            return coordinate < 0 ? -1.0f : 1.0f;
+        }
+        return (coordinate + 0.5f) * (2.0f / CUBE_SIZE) - 1.0f;
+    };
+
+    for (int face = 0; face < CUBE_DEPTH; ++face) {
+        const FaceFrame& frame = FRAMES[face];
+        for (int y = 0; y < CUBE_SIZE; ++y) {
+            for (int x = 0; x < CUBE_SIZE; ++x) {
+                int index = face * FACE_PIXELS + y * CUBE_SIZE + x;
+                std::array<float, 3> point;
+                point[frame.normalAxis] = toSpace(frame.normalSign > 0 ? CUBE_SIZE : -1);
+                point[frame.uAxis] = toSpace(toLattice(frame.uSign, x));
+                point[frame.vAxis] = toSpace(toLattice(frame.vSign, y));
+                positions[index] = {point[X], point[Y], point[Z]};
+
+                for (int n = 0; n < NEIGHBORS_4; ++n) {
+                    neighbors4[index * NEIGHBORS_4 + n] =
+                        static_cast<uint16_t>(resolve(face, x + OFFSETS_4[n][0], y + OFFSETS_4[n][1]));
+                }
+                for (int n = 0; n < NEIGHBORS_8; ++n) {
+                    neighbors8[index * NEIGHBORS_8 + n] =
+                        static_cast<uint16_t>(resolve(face, x + OFFSETS_8[n][0], y + OFFSETS_8[n][1]));
+                }
+            }
+        }
+
+        // Top and bottom padding rows, then the left and right columns
+        auto& border = haloBorders[face];
+        for (int i = 0; i < CUBE_SIZE; ++i) {
+            border[i] = {static_cast<uint16_t>(i + 1), static_cast<uint16_t>(resolve(face, i, -1))};
+            border[CUBE_SIZE + i] = {static_cast<uint16_t>((HALO_SIZE - 1) * HALO_SIZE + i + 1),
+                                     static_cast<uint16_t>(resolve(face, i, CUBE_SIZE))};
+            border[2 * CUBE_SIZE + i] = {static_cast<uint16_t>((i + 1) * HALO_SIZE),
+                                         static_cast<uint16_t>(resolve(face, -1, i))};
+            border[3 * CUBE_SIZE + i] = {static_cast<uint16_t>((i + 1) * HALO_SIZE + HALO_SIZE - 1),
+                                         static_cast<uint16_t>(resolve(face, CUBE_SIZE, i))};
+        }
+    }
+}
+
+} // namespace LEDCube
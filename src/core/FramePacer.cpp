@@ -0,0 +1,62 @@
+#include "core/FramePacer.h"
+
+namespace LEDCube {
+
+FramePacer::FramePacer(const FramePacerOptions& options)
+    : options(options), period(std::chrono::steady_clock::duration::zero()),
+      frames(0), deadlines(0), missedDeadlines(0), skippedFrames(0) {
+    if (options.targetRate > 0.0) {
+        period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(1.0 / options.targetRate));
+    }
+    start();
+}
+
+void FramePacer::start() {
+    startTime = std::chrono::steady_clock::now();
+    deadline = startTime + period;
+    frames = 0;
+    deadlines = 0;
+    missedDeadlines = 0;
+    skippedFrames = 0;
+}
+
+int FramePacer::waitForNextFrame() {
+    if (period == std::chrono::steady_clock::duration::zero()) {
+        return 0;
+    }
+    ++deadlines;
+
+    auto now = std::chrono::steady_clock::now();
+    int skipped = 0;
+    if (now <= deadline) {
+        Realtime::waitUntil(deadline, options.spinWindow);
+        wakeLateness.record(deadline, std::chrono::steady_clock::now(), period);
+    } else {
+        // Late: start the next frame now. A whole period or more behind,
+        // drop the deadlines that have passed and rejoin the grid.
+        ++missedDeadlines;
+        auto behind = (now - deadline) / period;
+        skipped = static_cast<int>(behind);
+        skippedFrames += skipped;
+        deadline += behind * period;
+    }
+    deadline += period;
+    return skipped;
+}
+
+FramePacerStats FramePacer::getStats() const {
+    FramePacerStats stats;
+    stats.frames = frames;
+    stats.deadlines = deadlines;
+    stats.missedDeadlines = missedDeadlines;
+    stats.skippedFrames = skippedFrames;
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    stats.achievedRate = elapsed > 0.0 ? frames / elapsed : 0.0;
+    JitterStats wake = wakeLateness.getStats();
+    stats.wakeP99Us = wake.p99Us;
+    stats.wakeMaxUs = wake.maxUs;
+    return stats;
+}
+
+} // namespace LEDCube
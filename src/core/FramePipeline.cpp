@@ -0,0 +1,187 @@
+#include "core/FramePipeline.h"
+#include <algorithm>
+
+namespace LEDCube {
+
+FramePipeline::FramePipeline(Producer producer, const FramePipelineOptions& options)
+    : producer(std::move(producer)), options(options), readIndex(0), writeIndex(0), readyCount(0),
+      consumerHolds(false), stopping(false), framesProduced(0), framesPresented(0), stalls(0),
+      produceNs(0), latencyMaxNs(0) {
+    this->options.depth = std::max(0, options.depth);
+    for (int i = 0; this->options.depth > 0 && i <= this->options.depth; ++i) {
+        slots.push_back(std::make_unique<Slot>());
+    }
+}
+
+FramePipeline::~FramePipeline() {
+    stop();
+}
+
+void FramePipeline::start() {
+    if (options.depth == 0 || thread.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = false;
+    }
+    thread = std::thread(&FramePipeline::produceLoop, this);
+}
+
+void FramePipeline::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    slotFree.notify_all();
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+void FramePipeline::post(std::function<void()> command) {
+    std::lock_guard<std::mutex> lock(mutex);
+    commands.push_back(std::move(command));
+}
+
+void FramePipeline::produce() {
+    std::vector<std::function<void()>> pending;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.swap(commands);
+    }
+    auto startTime = std::chrono::steady_clock::now();
+    for (auto& command : pending) {
+        command();
+    }
+
+    // Advance by the time since the previous frame's input
+    auto inputTime = std::chrono::steady_clock::now();
+    double deltaTime = 1.0 / (options.frameRate > 0.0 ? options.frameRate : 60.0);
+    if (workingInputTime != std::chrono::steady_clock::time_point()) {
+        deltaTime = std::min(std::chrono::duration<double>(inputTime - workingInputTime).count(), options.maxDeltaTime);
+    }
+    workingInputTime = inputTime;
+    producer(working, deltaTime);
+
+    auto elapsed = std::chrono::steady_clock::now() - startTime;
+    produceNs.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(), std::memory_order_relaxed);
+    framesProduced.fetch_add(1, std::memory_order_relaxed);
+}
+
+void FramePipeline::produceLoop() {
+    FrameProfiler::setThreadName("producer");
+
+    while (true) {
+        // Wait until fewer than depth frames are queued before sampling
+        // input, so a frame waits at most depth frames; with depth + 1
+        // slots one is then free even while the consumer holds another
+        Slot* slot;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            slotFree.wait(lock, [this]() {
+                return stopping || readyCount < static_cast<size_t>(options.depth);
+            });
+            if (stopping) {
+                return;
+            }
+            slot = slots[writeIndex].get();
+        }
+
+        produce();
+
+        // The slot still holds an older frame; only rows changed since then
+        // need copying
+        const DirtyMasks& changed = working.getDirtyMasks();
+        for (auto& other : slots) {
+            for (int face = 0; face < CUBE_DEPTH; ++face) {
+                other->staleRows[face] |= changed[face];
+            }
+        }
+        slot->cube.copyFrom(working, slot->staleRows);
+        slot->staleRows.fill(0);
+        slot->inputTime = workingInputTime;
+        working.resetDirty();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            writeIndex = (writeIndex + 1) % slots.size();
+            ++readyCount;
+        }
+        frameReady.notify_one();
+    }
+}
+
+const LEDCube* FramePipeline::acquireFrame(std::chrono::nanoseconds timeout) {
+    if (options.depth == 0) {
+        // Everything runs on the calling thread, so no lock is needed
+        if (!consumerHolds) {
+            produce();
+            consumerHolds = true;
+        }
+        return &working;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    if (consumerHolds) {
+        return &slots[readIndex]->cube;
+    }
+    if (!frameReady.wait_for(lock, timeout, [this]() { return readyCount > 0; })) {
+        stalls.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    --readyCount;
+    consumerHolds = true;
+    return &slots[readIndex]->cube;
+}
+
+void FramePipeline::releaseFrame() {
+    if (options.depth == 0) {
+        if (!consumerHolds) {
+            return;
+        }
+        consumerHolds = false;
+        working.resetDirty();
+        recordPresented(workingInputTime);
+        return;
+    }
+
+    std::chrono::steady_clock::time_point inputTime;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!consumerHolds) {
+            return;
+        }
+        inputTime = slots[readIndex]->inputTime;
+        readIndex = (readIndex + 1) % slots.size();
+        consumerHolds = false;
+    }
+    slotFree.notify_one();
+    recordPresented(inputTime);
+}
+
+void FramePipeline::recordPresented(std::chrono::steady_clock::time_point inputTime) {
+    auto elapsed = std::chrono::steady_clock::now() - inputTime;
+    uint64_t ns = static_cast<uint64_t>(std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    latency.record(ns);
+    if (ns > latencyMaxNs.load(std::memory_order_relaxed)) {
+        latencyMaxNs.store(ns, std::memory_order_relaxed);
+    }
+    framesPresented.fetch_add(1, std::memory_order_relaxed);
+}
+
+FramePipelineStats FramePipeline::getStats() const {
+    FramePipelineStats stats;
+    stats.framesProduced = framesProduced.load(std::memory_order_relaxed);
+    stats.framesPresented = framesPresented.load(std::memory_order_relaxed);
+    stats.stalls = stalls.load(std::memory_order_relaxed);
+    stats.latencyP50Ms = latency.getPercentile(0.50) / 1e6;
+    stats.latencyP99Ms = latency.getPercentile(0.99) / 1e6;
+    stats.latencyMaxMs = latencyMaxNs.load(std::memory_order_relaxed) / 1e6;
+    if (stats.framesProduced > 0) {
+        stats.produceAvgMs = produceNs.load(std::memory_order_relaxed) / 1e6 / stats.framesProduced;
+    }
+    return stats;
+}
+
+} // namespace LEDCube
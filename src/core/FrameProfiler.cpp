@@ -0,0 +1,187 @@
+#include "core/FrameProfiler.h"
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace LEDCube {
+
+namespace {
+
+constexpr int STAGE_COUNT = static_cast<int>(FrameStage::Count);
+
+// Summary of one stage over a reporting interval
+struct StageSummary {
+    uint64_t count = 0;
+    double p50Ms = 0.0;
+    double p99Ms = 0.0;
+    double maxMs = 0.0;
+};
+
+// Histograms owned by one thread, plus the reader's copy of the counts at
+// the previous report so each report covers only the latest interval
+struct ThreadProfile {
+    std::string name;
+    std::array<LatencyHistogram, STAGE_COUNT> histograms;
+    std::vector<uint64_t> reportedCounts = std::vector<uint64_t>(STAGE_COUNT * LatencyHistogram::BUCKET_COUNT, 0);
+};
+
+std::mutex registryMutex;
+std::vector<std::unique_ptr<ThreadProfile>>& registry() {
+    static std::vector<std::unique_ptr<ThreadProfile>> profiles;
+    return profiles;
+}
+
+// Registration takes the lock once per thread; recording never does
+ThreadProfile& currentThreadProfile() {
+    thread_local ThreadProfile* profile = nullptr;
+    if (!profile) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        registry().push_back(std::make_unique<ThreadProfile>());
+        profile = registry().back().get();
+        profile->name = "thread " + std::to_string(registry().size());
+    }
+    return *profile;
+}
+
+} // namespace
+
+std::atomic<bool> FrameProfiler::enabledFlag{true};
+
+const char* frameStageName(FrameStage stage) {
+    switch (stage) {
+        case FrameStage::Update:  return "update";
+        case FrameStage::Render:  return "render";
+        case FrameStage::Convert: return "convert";
+        case FrameStage::Upload:  return "upload";
+        case FrameStage::ScanOut: return "scan-out";
+        case FrameStage::Present: return "present";
+        case FrameStage::Sleep:   return "sleep";
+        default:                  return "unknown";
+    }
+}
+
+int LatencyHistogram::bucketIndex(uint64_t value) {
+    if (value < SUB_BUCKETS) {
+        return static_cast<int>(value);
+    }
+
+    int exponent = 63 - __builtin_clzll(value);
+    if (exponent > MAX_EXPONENT) {
+        return BUCKET_COUNT - 1;
+    }
+
+    int subBucket = static_cast<int>((value >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1));
+    return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + subBucket;
+}
+
+uint64_t LatencyHistogram::bucketLowerBound(int bucket) {
+    if (bucket < SUB_BUCKETS) {
+        return bucket;
+    }
+
+    int exponent = bucket / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+    uint64_t subBucket = bucket % SUB_BUCKETS;
+    return (SUB_BUCKETS + subBucket) << (exponent - SUB_BUCKET_BITS);
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(int bucket) {
+    if (bucket < SUB_BUCKETS) {
+        return bucket;
+    }
+
+    int exponent = bucket / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+    return bucketLowerBound(bucket) + (uint64_t(1) << (exponent - SUB_BUCKET_BITS)) - 1;
+}
+
+uint64_t LatencyHistogram::getTotalCount() const {
+    uint64_t total = 0;
+    for (int b = 0; b < BUCKET_COUNT; ++b) {
+        total += getCount(b);
+    }
+    return total;
+}
+
+uint64_t LatencyHistogram::getPercentile(double fraction) const {
+    uint64_t target = static_cast<uint64_t>(fraction * getTotalCount());
+    uint64_t seen = 0;
+    for (int b = 0; b < BUCKET_COUNT; ++b) {
+        seen += getCount(b);
+        if (seen > target) {
+            return bucketLowerBound(b) + (bucketUpperBound(b) - bucketLowerBound(b)) / 2;
+        }
+    }
+    return 0;
+}
+
+void FrameProfiler::setThreadName(const std::string& name) {
+    ThreadProfile& profile = currentThreadProfile();
+    std::lock_guard<std::mutex> lock(registryMutex);
+    profile.name = name;
+}
+
+void FrameProfiler::record(FrameStage stage, uint64_t nanoseconds) {
+    currentThreadProfile().histograms[static_cast<int>(stage)].record(nanoseconds);
+}
+
+void FrameProfiler::report(std::ostream& out) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+
+    std::vector<uint64_t> interval(LatencyHistogram::BUCKET_COUNT);
+    auto flags = out.flags();
+    auto precision = out.precision();
+
+    out << "Frame timing (since last report):" << std::endl;
+    for (auto& profile : registry()) {
+        for (int stage = 0; stage < STAGE_COUNT; ++stage) {
+            const LatencyHistogram& histogram = profile->histograms[stage];
+            uint64_t* reported = profile->reportedCounts.data() + stage * LatencyHistogram::BUCKET_COUNT;
+
+            // Interval counts are the growth since the previous report
+            StageSummary summary;
+            int maxBucket = -1;
+            for (int b = 0; b < LatencyHistogram::BUCKET_COUNT; ++b) {
+                uint64_t count = histogram.getCount(b);
+                interval[b] = count - reported[b];
+                reported[b] = count;
+                summary.count += interval[b];
+                if (interval[b] != 0) {
+                    maxBucket = b;
+                }
+            }
+            if (summary.count == 0) {
+                continue;
+            }
+
+            auto percentileMs = [&](double fraction) {
+                uint64_t target = static_cast<uint64_t>(fraction * summary.count);
+                uint64_t seen = 0;
+                for (int b = 0; b < LatencyHistogram::BUCKET_COUNT; ++b) {
+                    seen += interval[b];
+                    if (seen > target) {
+                        uint64_t lower = LatencyHistogram::bucketLowerBound(b);
+                        uint64_t upper = LatencyHistogram::bucketUpperBound(b);
+                        return (lower + (upper - lower) / 2) / 1e6;
+                    }
+                }
+                return LatencyHistogram::bucketUpperBound(maxBucket) / 1e6;
+            };
+            summary.p50Ms = percentileMs(0.50);
+            summary.p99Ms = percentileMs(0.99);
+            summary.maxMs = LatencyHistogram::bucketUpperBound(maxBucket) / 1e6;
+
+            out << "  [" << profile->name << "] " << std::left << std::setw(9)
+                << frameStageName(static_cast<FrameStage>(stage)) << std::right
+                << " n=" << std::setw(6) << summary.count
+                << std::fixed << std::setprecision(3)
+                << "  p50=" << summary.p50Ms << " ms"
+                << "  p99=" << summary.p99Ms << " ms"
+                << "  max=" << summary.maxMs << " ms" << std::endl;
+        }
+    }
+
+    out.flags(flags);
+    out.precision(precision);
+}
+
+} // namespace LEDCube
@@ -0,0 +1,277 @@
+#include "core/JobSystem.h"
+#include "core/Realtime.h"
+#include <algorithm>
+
+namespace LEDCube {
+
+namespace {
+
+// The pool and worker index of the calling thread; -1 outside any pool
+thread_local const JobSystem* currentSystem = nullptr;
+thread_local int currentWorker = -1;
+
+// Spins before a worker goes to sleep, and between polls while waiting
+constexpr int IDLE_SPINS = 64;
+
+std::mutex sharedMutex;
+JobSystemOptions sharedOptions;
+std::unique_ptr<JobSystem> sharedSystem;
+
+// Context of one parallelFor, on the caller's stack
+struct RangeJob {
+    const std::function<void(int, int)>* body;
+    int count;
+    int grain;
+};
+
+void runRange(void* context, int index) {
+    const RangeJob& range = *static_cast<const RangeJob*>(context);
+    int begin = index * range.grain;
+    (*range.body)(begin, std::min(range.count, begin + range.grain));
+}
+
+} // namespace
+
+bool JobSystem::TaskDeque::push(const Task& task) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (tail - head == CAPACITY) {
+        return false;
+    }
+    tasks[tail % CAPACITY] = task;
+    ++tail;
+    return true;
+}
+
+bool JobSystem::TaskDeque::pop(Task& task) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (tail == head) {
+        return false;
+    }
+    --tail;
+    task = tasks[tail % CAPACITY];
+    return true;
+}
+
+bool JobSystem::TaskDeque::steal(Task& task) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (tail == head) {
+        return false;
+    }
+    task = tasks[head % CAPACITY];
+    ++head;
+    return true;
+}
+
+JobSystem::JobSystem(const JobSystemOptions& options)
+    : queuedTasks(0), sleepingWorkers(0), stopping(false) {
+    // Allowed cores: the given ones (or all) less the excluded ones
+    std::vector<int> candidates = options.cpus;
+    if (candidates.empty()) {
+        for (int cpu = 0; cpu < Realtime::getCpuCount(); ++cpu) {
+            candidates.push_back(cpu);
+        }
+    }
+    for (int cpu : candidates) {
+        if (std::find(options.excludedCpus.begin(), options.excludedCpus.end(), cpu) == options.excludedCpus.end()) {
+            cpus.push_back(cpu);
+        }
+    }
+    if (cpus.empty()) {
+        cpus = candidates;
+    }
+    bool restricted = !options.cpus.empty() || cpus.size() < candidates.size();
+
+    int workerCount = options.workers >= 0 ? options.workers : std::max(0, static_cast<int>(cpus.size()) - 1);
+    for (int i = 0; i <= workerCount; ++i) {
+        deques.push_back(std::make_unique<TaskDeque>());
+    }
+    workers.reserve(workerCount);
+    for (int i = 0; i < workerCount; ++i) {
+        workers.emplace_back([this, i, restricted]() {
+            if (restricted) {
+                Realtime::pinToCpus(cpus);
+            }
+            workerLoop(i);
+        });
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping.store(true);
+    }
+    wakeUp.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+JobSystem& JobSystem::shared() {
+    std::lock_guard<std::mutex> lock(sharedMutex);
+    if (!sharedSystem) {
+        sharedSystem = std::make_unique<JobSystem>(sharedOptions);
+    }
+    return *sharedSystem;
+}
+
+bool JobSystem::configureShared(const JobSystemOptions& options) {
+    std::lock_guard<std::mutex> lock(sharedMutex);
+    if (sharedSystem) {
+        return false;
+    }
+    sharedOptions = options;
+    return true;
+}
+
+int JobSystem::currentDeque() const {
+    return currentSystem == this && currentWorker >= 0 ? currentWorker : static_cast<int>(workers.size());
+}
+
+void JobSystem::push(const Task& task) {
+    // No workers to run it, or queue full: the submitter does the work
+    // itself, so a job that is never waited on still runs
+    if (workers.empty() || !deques[currentDeque()]->push(task)) {
+        execute(task);
+        return;
+    }
+    queuedTasks.fetch_add(1);
+    if (sleepingWorkers.load() > 0) {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        wakeUp.notify_one();
+    }
+}
+
+bool JobSystem::findTask(int home, Task& task) {
+    // Newest task of our own deque, else the oldest of the others
+    bool found = deques[home]->pop(task);
+    for (size_t i = 1; !found && i < deques.size(); ++i) {
+        found = deques[(home + i) % deques.size()]->steal(task);
+    }
+    if (found) {
+        queuedTasks.fetch_sub(1);
+    }
+    return found;
+}
+
+void JobSystem::execute(const Task& task) {
+    task.run(task.context, task.index);
+    finish(task.counter);
+}
+
+void JobSystem::finish(JobCounter* counter) {
+    if (!counter) {
+        return;
+    }
+
+    // Under the counter's lock, so a waiter that saw zero can lock it once
+    // more to know this thread is done with the counter
+    std::vector<JobCounter::Continuation> released;
+    {
+        std::lock_guard<std::mutex> lock(counter->mutex);
+        if (counter->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            released.swap(counter->continuations);
+        }
+    }
+    for (auto& continuation : released) {
+        auto* job = new std::function<void()>(std::move(continuation.job));
+        push({&JobSystem::runJob, job, 0, continuation.counter});
+    }
+}
+
+void JobSystem::runJob(void* context, int) {
+    std::unique_ptr<std::function<void()>> job(static_cast<std::function<void()>*>(context));
+    (*job)();
+}
+
+void JobSystem::submit(std::function<void()> job, JobCounter* counter) {
+    if (counter) {
+        counter->pending.fetch_add(1, std::memory_order_relaxed);
+    }
+    push({&JobSystem::runJob, new std::function<void()>(std::move(job)), 0, counter});
+}
+
+void JobSystem::submitAfter(JobCounter& dependency, std::function<void()> job, JobCounter* counter) {
+    if (counter) {
+        counter->pending.fetch_add(1, std::memory_order_relaxed);
+    }
+    {
+        std::lock_guard<std::mutex> lock(dependency.mutex);
+        if (dependency.pending.load(std::memory_order_acquire) != 0) {
+            dependency.continuations.push_back({std::move(job), counter});
+            return;
+        }
+    }
+    push({&JobSystem::runJob, new std::function<void()>(std::move(job)), 0, counter});
+}
+
+void JobSystem::wait(JobCounter& counter) {
+    help(currentDeque(), counter);
+}
+
+void JobSystem::help(int home, JobCounter& counter) {
+    int idle = 0;
+    while (!counter.isDone()) {
+        Task task;
+        if (findTask(home, task)) {
+            execute(task);
+            idle = 0;
+        } else if (++idle >= IDLE_SPINS) {
+            // The last tasks are running elsewhere
+            std::this_thread::yield();
+            idle = 0;
+        }
+    }
+    std::lock_guard<std::mutex> lock(counter.mutex);
+}
+
+void JobSystem::parallelFor(int count, int grain, const std::function<void(int begin, int end)>& body) {
+    if (count <= 0) {
+        return;
+    }
+    grain = std::max(1, grain);
+    int chunks = (count + grain - 1) / grain;
+    if (chunks == 1 || workers.empty()) {
+        body(0, count);
+        return;
+    }
+
+    // The caller takes the first range and helps with the rest
+    RangeJob range{&body, count, grain};
+    JobCounter counter;
+    counter.pending.store(chunks - 1, std::memory_order_relaxed);
+    for (int chunk = chunks - 1; chunk >= 1; --chunk) {
+        push({&runRange, &range, chunk, &counter});
+    }
+    runRange(&range, 0);
+    wait(counter);
+}
+
+void JobSystem::workerLoop(int index) {
+    currentSystem = this;
+    currentWorker = index;
+
+    int idle = 0;
+    while (true) {
+        Task task;
+        if (findTask(index, task)) {
+            execute(task);
+            idle = 0;
+            continue;
+        }
+        if (++idle < IDLE_SPINS) {
+            continue;
+        }
+        idle = 0;
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleepingWorkers.fetch_add(1);
+        wakeUp.wait(lock, [this]() { return stopping.load() || queuedTasks.load() > 0; });
+        sleepingWorkers.fetch_sub(1);
+        if (stopping.load()) {
+            return;
+        }
+    }
+}
+
+} // namespace LEDCube
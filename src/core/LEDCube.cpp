@@ -1,4 +1,5 @@
 #include "core/LEDCube.h"
+#include <algorithm>
 #include <cstring>
 #include <stdexcept>
 
@@ -6,6 +7,8 @@ namespace LEDCube {
 
 LEDCube::LEDCube() {
     buffer.resize(TOTAL_LEDS, Color::Black());
+    dirtyRows.fill(ALL_ROWS_DIRTY);
+    litRows.fill(0);
 }
 
 LEDCube::~LEDCube() {
@@ -17,7 +20,17 @@ void LEDCube::setLED(const Position& pos, const Color& color) {
     }
     
     int index = positionToIndex(pos);
+    if (buffer[index] == color) {
+        return;
+    }
+    
     buffer[index] = color;
+    
+    uint64_t rowBit = uint64_t(1) << pos.y;
+    dirtyRows[pos.z] |= rowBit;
+    if (color != Color::Black()) {
+        litRows[pos.z] |= rowBit;
+    }
 }
 
 Color LEDCube::getLED(const Position& pos) const {
@@ -34,9 +47,28 @@ void LEDCube::clear() {
 }
 
 void LEDCube::fill(const Color& color) {
+    if (color == Color::Black()) {
+        // Only rows that may hold lit pixels need clearing
+        for (int face = 0; face < CUBE_DEPTH; ++face) {
+            uint64_t rows = litRows[face];
+            while (rows != 0) {
+                int y = __builtin_ctzll(rows);
+                rows &= rows - 1;
+                
+                Color* row = buffer.data() + face * (CUBE_SIZE * CUBE_SIZE) + y * CUBE_SIZE;
+                std::fill_n(row, CUBE_SIZE, Color::Black());
+            }
+            dirtyRows[face] |= litRows[face];
+            litRows[face] = 0;
+        }
+        return;
+    }
+    
     for (auto& led : buffer) {
         led = color;
     }
+    dirtyRows.fill(ALL_ROWS_DIRTY);
+    litRows.fill(ALL_ROWS_DIRTY);
 }
 
 void LEDCube::setBuffer(const std::vector<Color>& newBuffer) {
@@ -44,6 +76,45 @@ void LEDCube::setBuffer(const std::vector<Color>& newBuffer) {
         throw std::invalid_argument("Buffer size must match total LED count");
     }
     buffer = newBuffer;
+    dirtyRows.fill(ALL_ROWS_DIRTY);
+    litRows.fill(ALL_ROWS_DIRTY);
+}
+
+void LEDCube::copyFrom(const LEDCube& other, const DirtyMasks& rows) {
+    for (int face = 0; face < CUBE_DEPTH; ++face) {
+        uint64_t remaining = rows[face];
+        while (remaining != 0) {
+            int y = __builtin_ctzll(remaining);
+            remaining &= remaining - 1;
+            
+            size_t offset = face * (CUBE_SIZE * CUBE_SIZE) + y * CUBE_SIZE;
+            std::copy_n(other.buffer.data() + offset, CUBE_SIZE, buffer.data() + offset);
+        }
+    }
+    dirtyRows = other.dirtyRows;
+    litRows = other.litRows;
+}
+
+void LEDCube::commitRows(int face, uint64_t written, uint64_t changed, uint64_t lit) {
+    dirtyRows[face] |= changed;
+    litRows[face] = (litRows[face] & ~written) | lit;
+}
+
+bool LEDCube::isDirty() const {
+    for (uint64_t rows : dirtyRows) {
+        if (rows != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void LEDCube::resetDirty() {
+    dirtyRows.fill(0);
+}
+
+void LEDCube::markAllDirty() {
+    dirtyRows.fill(ALL_ROWS_DIRTY);
 }
 
 bool LEDCube::isValidPosition(const Position& pos) const {
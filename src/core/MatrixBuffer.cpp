@@ -1,10 +1,12 @@
 #include "core/MatrixBuffer.h"
+#include <algorithm>
 #include <stdexcept>
 
 namespace LEDCube {
 
-MatrixBuffer::MatrixBuffer() {
+MatrixBuffer::MatrixBuffer(BufferLayout layout) : layout(layout) {
     buffer.resize(TOTAL_LEDS, Color::Black());
+    dirtyRows.fill(ALL_ROWS_DIRTY);
 }
 
 MatrixBuffer::~MatrixBuffer() {
@@ -14,7 +16,54 @@ void MatrixBuffer::setBuffer(const std::vector<Color>& colors) {
     if (colors.size() != TOTAL_LEDS) {
         throw std::invalid_argument("Buffer size must match total LED count");
     }
-    buffer = colors;
+    if (layout == BufferLayout::FaceMajor) {
+        buffer = colors;
+    } else {
+        convertLayout(colors.data(), BufferLayout::FaceMajor, buffer.data(), layout);
+    }
+    dirtyRows.fill(ALL_ROWS_DIRTY);
+}
+
+void MatrixBuffer::setLayout(BufferLayout newLayout) {
+    if (newLayout == layout) {
+        return;
+    }
+    std::vector<Color> reordered(TOTAL_LEDS);
+    convertLayout(buffer.data(), layout, reordered.data(), newLayout);
+    buffer.swap(reordered);
+    layout = newLayout;
+}
+
+int MatrixBuffer::layoutIndex(BufferLayout layout, int x, int y, int face) {
+    if (layout == BufferLayout::ScanOrder) {
+        int column = (CUBE_DEPTH - 1 - face) * CUBE_SIZE + x;
+        return ((y % SCAN_ROW_PAIRS) * SCAN_COLUMNS + column) * 2 + y / SCAN_ROW_PAIRS;
+    }
+    return face * (CUBE_SIZE * CUBE_SIZE) + y * CUBE_SIZE + x;
+}
+
+void MatrixBuffer::convertLayout(const Color* source, BufferLayout from, Color* destination, BufferLayout to) {
+    if (from == to) {
+        std::copy(source, source + TOTAL_LEDS, destination);
+        return;
+    }
+    
+    // Walk the face-major side row by row; the scan-order side then moves
+    // through one row pair with a stride of two pixels
+    bool toScan = to == BufferLayout::ScanOrder;
+    for (int face = 0; face < CUBE_DEPTH; ++face) {
+        for (int y = 0; y < CUBE_SIZE; ++y) {
+            size_t row = static_cast<size_t>(face * (CUBE_SIZE * CUBE_SIZE) + y * CUBE_SIZE);
+            size_t scan = static_cast<size_t>(layoutIndex(BufferLayout::ScanOrder, 0, y, face));
+            for (int x = 0; x < CUBE_SIZE; ++x) {
+                if (toScan) {
+                    destination[scan + 2 * x] = source[row + x];
+                } else {
+                    destination[row + x] = source[scan + 2 * x];
+                }
+            }
+        }
+    }
 }
 
 void MatrixBuffer::setLED(const Position& pos, const Color& color) {
@@ -24,6 +73,7 @@ void MatrixBuffer::setLED(const Position& pos, const Color& color) {
     
     int index = positionToIndex(pos);
     buffer[index] = color;
+    dirtyRows[pos.z] |= uint64_t(1) << pos.y;
 }
 
 Color MatrixBuffer::getLED(const Position& pos) const {
@@ -43,35 +93,60 @@ void MatrixBuffer::fill(const Color& color) {
     for (auto& led : buffer) {
         led = color;
     }
+    dirtyRows.fill(ALL_ROWS_DIRTY);
 }
 
 void MatrixBuffer::copyFrom(const MatrixBuffer& other) {
-    buffer = other.buffer;
+    if (other.layout == layout) {
+        buffer = other.buffer;
+    } else {
+        convertLayout(other.buffer.data(), other.layout, buffer.data(), layout);
+    }
+    dirtyRows = other.dirtyRows;
 }
 
-std::vector<uint8_t> MatrixBuffer::toRGB888() const {
-    std::vector<uint8_t> rgb888;
-    rgb888.reserve(TOTAL_LEDS * 3);
-    
-    for (const auto& color : buffer) {
-        rgb888.push_back(color.r);
-        rgb888.push_back(color.g);
-        rgb888.push_back(color.b);
+void MatrixBuffer::copyFrom(const LEDCube& cube) {
+    if (layout == BufferLayout::FaceMajor) {
+        buffer = cube.getBuffer();
+    } else {
+        convertLayout(cube.getBuffer().data(), BufferLayout::FaceMajor, buffer.data(), layout);
     }
-    
+    dirtyRows = cube.getDirtyMasks();
+}
+
+bool MatrixBuffer::isDirty() const {
+    for (uint64_t rows : dirtyRows) {
+        if (rows != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void MatrixBuffer::resetDirty() {
+    dirtyRows.fill(0);
+}
+
+void MatrixBuffer::markAllDirty() {
+    dirtyRows.fill(ALL_ROWS_DIRTY);
+}
+
+void MatrixBuffer::convertTo(PixelFormat format, uint8_t* destination, size_t destinationSize, uint8_t brightness) const {
+    if (destinationSize < buffer.size() * bytesPerPixel(format)) {
+        throw std::invalid_argument("Destination buffer too small for conversion");
+    }
+    convertPixels(buffer.data(), buffer.size(), destination, format, brightness);
+}
+
+std::vector<uint8_t> MatrixBuffer::toRGB888() const {
+    std::vector<uint8_t> rgb888(buffer.size() * 3);
+    convertTo(PixelFormat::RGB888, rgb888.data(), rgb888.size());
     return rgb888;
 }
 
 std::vector<uint8_t> MatrixBuffer::toRGB565() const {
-    std::vector<uint8_t> rgb565;
-    rgb565.reserve(TOTAL_LEDS * 2);
-    
-    for (const auto& color : buffer) {
-        uint16_t rgb = colorToRGB565(color);
-        rgb565.push_back((rgb >> 8) & 0xFF);
-        rgb565.push_back(rgb & 0xFF);
-    }
-    
+    std::vector<uint8_t> rgb565(buffer.size() * 2);
+    convertTo(PixelFormat::RGB565BE, rgb565.data(), rgb565.size());
     return rgb565;
 }
 
@@ -84,7 +159,7 @@ bool MatrixBuffer::isValidPosition(const Position& pos) const {
 }
 
 int MatrixBuffer::positionToIndex(const Position& pos) const {
-    return pos.z * (CUBE_SIZE * CUBE_SIZE) + pos.y * CUBE_SIZE + pos.x;
+    return layoutIndex(layout, pos.x, pos.y, pos.z);
 }
 
 Position MatrixBuffer::indexToPosition(int index) const {
@@ -92,6 +167,13 @@ Position MatrixBuffer::indexToPosition(int index) const {
         return Position();
     }
     
+    if (layout == BufferLayout::ScanOrder) {
+        int half = index % 2;
+        int column = (index / 2) % SCAN_COLUMNS;
+        int rowPair = index / (2 * SCAN_COLUMNS);
+        return Position(column % CUBE_SIZE, rowPair + half * SCAN_ROW_PAIRS, CUBE_DEPTH - 1 - column / CUBE_SIZE);
+    }
+    
     int z = index / (CUBE_SIZE * CUBE_SIZE);
     int remainder = index % (CUBE_SIZE * CUBE_SIZE);
     int y = remainder / CUBE_SIZE;
@@ -100,22 +182,4 @@ Position MatrixBuffer::indexToPosition(int index) const {
     return Position(x, y, z);
 }
 
-uint16_t MatrixBuffer::colorToRGB565(const Color& color) const {
-    // Convert 8-bit RGB to 5-6-5 format
-    uint8_t r = (color.r * 31) / 255;  // 5 bits
-    uint8_t g = (color.g * 63) / 255;  // 6 bits
-    uint8_t b = (color.b * 31) / 255;  // 5 bits
-    
-    return (r << 11) | (g << 5) | b;
-}
-
-Color MatrixBuffer::rgb565ToColor(uint16_t rgb565) const {
-    // Convert 5-6-5 format to 8-bit RGB
-    uint8_t r = ((rgb565 >> 11) & 0x1F) * 255 / 31;
-    uint8_t g = ((rgb565 >> 5) & 0x3F) * 255 / 63;
-    uint8_t b = (rgb565 & 0x1F) * 255 / 31;
-    
-    return Color(r, g, b);
-}
-
 } // namespace LEDCube 
\ No newline at end of file
@@ -0,0 +1,95 @@
+#include "core/ParticleSystem.h"
+#include <limits>
+
+namespace LEDCube {
+
+ParticleSystem::ParticleSystem(size_t capacity)
+    : posX(capacity), posY(capacity), posZ(capacity),
+      velX(capacity), velY(capacity), velZ(capacity),
+      life(capacity), color(capacity), count(0) {
+}
+
+bool ParticleSystem::spawn(float x, float y, float z,
+                           float vx, float vy, float vz,
+                           const Color& particleColor, float lifetime) {
+    if (isFull()) {
+        return false;
+    }
+
+    size_t i = count++;
+    posX[i] = x;
+    posY[i] = y;
+    posZ[i] = z;
+    velX[i] = vx;
+    velY[i] = vy;
+    velZ[i] = vz;
+    life[i] = lifetime < 0.0f ? std::numeric_limits<float>::infinity() : lifetime;
+    color[i] = particleColor;
+    return true;
+}
+
+void ParticleSystem::kill(size_t index) {
+    if (index >= count) {
+        return;
+    }
+
+    // Swap-and-pop: move the last particle into the freed slot
+    size_t last = --count;
+    posX[index] = posX[last];
+    posY[index] = posY[last];
+    posZ[index] = posZ[last];
+    velX[index] = velX[last];
+    velY[index] = velY[last];
+    velZ[index] = velZ[last];
+    life[index] = life[last];
+    color[index] = color[last];
+}
+
+void ParticleSystem::integrate(float deltaTime, float ax, float ay, float az) {
+    const size_t n = count;
+    float* __restrict px = posX.data();
+    float* __restrict py = posY.data();
+    float* __restrict pz = posZ.data();
+    float* __restrict vx = velX.data();
+    float* __restrict vy = velY.data();
+    float* __restrict vz = velZ.data();
+    float* __restrict lt = life.data();
+
+    // Straight-line loops over contiguous arrays so the compiler can vectorize
+    for (size_t i = 0; i < n; ++i) {
+        vx[i] += ax * deltaTime;
+        vy[i] += ay * deltaTime;
+        vz[i] += az * deltaTime;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        px[i] += vx[i] * deltaTime;
+        py[i] += vy[i] * deltaTime;
+        pz[i] += vz[i] * deltaTime;
+        lt[i] -= deltaTime;
+    }
+}
+
+void ParticleSystem::removeDead() {
+    size_t i = 0;
+    while (i < count) {
+        bool alive = life[i] > 0.0f &&
+                     posX[i] >= 0.0f && posX[i] < CUBE_SIZE &&
+                     posY[i] >= 0.0f && posY[i] < CUBE_SIZE &&
+                     posZ[i] >= 0.0f && posZ[i] < CUBE_DEPTH;
+        if (alive) {
+            ++i;
+        } else {
+            // The swapped-in particle is checked on the next iteration
+            kill(i);
+        }
+    }
+}
+
+void ParticleSystem::rasterize(LEDCube& cube) const {
+    for (size_t i = 0; i < count; ++i) {
+        Position pos(static_cast<int>(posX[i]), static_cast<int>(posY[i]), static_cast<int>(posZ[i]));
+        cube.setLED(pos, color[i]);
+    }
+}
+
+} // namespace LEDCube
@@ -0,0 +1,488 @@
+#include "core/PixelFormat.h"
+#include <atomic>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define LEDCUBE_PIXEL_X86 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define LEDCUBE_PIXEL_NEON 1
+#endif
+
+namespace LEDCube {
+
+namespace {
+
+static_assert(sizeof(Color) == 3, "Color must be tightly packed RGB");
+
+// One implementation of each primitive the conversions are built from.
+// Every kernel handles any count and gives bit-identical results to the
+// scalar one.
+struct PixelKernels {
+    const char* name;
+    void (*scaleBytes)(const uint8_t* source, uint8_t* destination, size_t bytes, uint8_t brightness);
+    void (*swapRedBlue)(const uint8_t* source, uint8_t* destination, size_t pixels);
+    void (*toRGB565)(const uint8_t* source, uint8_t* destination, size_t pixels, uint8_t brightness, bool bigEndian);
+};
+
+// Scalar reference ---------------------------------------------------------
+
+inline uint8_t scaleChannel(uint8_t channel, uint8_t brightness) {
+    return static_cast<uint8_t>((channel * brightness + 127) / 255);
+}
+
+void scaleBytesScalar(const uint8_t* source, uint8_t* destination, size_t bytes, uint8_t brightness) {
+    for (size_t i = 0; i < bytes; ++i) {
+        destination[i] = scaleChannel(source[i], brightness);
+    }
+}
+
+void swapRedBlueScalar(const uint8_t* source, uint8_t* destination, size_t pixels) {
+    for (size_t i = 0; i < pixels; ++i) {
+        uint8_t r = source[i * 3];
+        destination[i * 3 + 1] = source[i * 3 + 1];
+        destination[i * 3] = source[i * 3 + 2];
+        destination[i * 3 + 2] = r;
+    }
+}
+
+void toRGB565Scalar(const uint8_t* source, uint8_t* destination, size_t pixels, uint8_t brightness, bool bigEndian) {
+    for (size_t i = 0; i < pixels; ++i) {
+        uint16_t r = scaleChannel(source[i * 3], brightness);
+        uint16_t g = scaleChannel(source[i * 3 + 1], brightness);
+        uint16_t b = scaleChannel(source[i * 3 + 2], brightness);
+        uint16_t rgb = static_cast<uint16_t>(((r * 31 / 255) << 11) | ((g * 63 / 255) << 5) | (b * 31 / 255));
+
+        uint8_t high = static_cast<uint8_t>(rgb >> 8);
+        uint8_t low = static_cast<uint8_t>(rgb & 0xFF);
+        destination[i * 2] = bigEndian ? high : low;
+        destination[i * 2 + 1] = bigEndian ? low : high;
+    }
+}
+
+const PixelKernels SCALAR_KERNELS = {"scalar", scaleBytesScalar, swapRedBlueScalar, toRGB565Scalar};
+
+#if defined(LEDCUBE_PIXEL_X86) || defined(LEDCUBE_PIXEL_NEON)
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "SIMD kernels store native little-endian words");
+#endif
+
+#if defined(LEDCUBE_PIXEL_X86)
+
+// SSSE3 / AVX2 ---------------------------------------------------------------
+//
+// Packed RGB is regrouped 16 pixels (48 bytes, three registers) at a time
+// with pshufb: output register o ORs together shuffles of all three input
+// registers through MASKS[o][input] (-128 zeroes a byte). AVX2 runs the
+// same shuffles on two independent 48-byte groups, one per 128-bit lane.
+// Division by 255 uses floor(x / 255) == (x + 1 + (x >> 8)) >> 8, exact
+// for x < 65280, which covers c * brightness + 127 and c * 63.
+
+#define LEDCUBE_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define LEDCUBE_TARGET_AVX2 __attribute__((target("avx2")))
+
+// Packed RGB -> planar R, G, B
+alignas(16) const int8_t DEINTERLEAVE_MASKS[3][3][16] = {
+    {
+        {   0,    3,    6,    9,   12,   15, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128},
+        {-128, -128, -128, -128, -128, -128,    2,    5,    8,   11,   14, -128, -128, -128, -128, -128},
+        {-128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128,    1,    4,    7,   10,   13},
+    },
+    {
+        {   1,    4,    7,   10,   13, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128},
+        {-128, -128, -128, -128, -128,    0,    3,    6,    9,   12,   15, -128, -128, -128, -128, -128},
+        {-128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128,    2,    5,    8,   11,   14},
+    },
+    {
+        {   2,    5,    8,   11,   14, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128},
+        {-128, -128, -128, -128, -128,    1,    4,    7,   10,   13, -128, -128, -128, -128, -128, -128},
+        {-128, -128, -128, -128, -128, -128, -128, -128, -128, -128,    0,    3,    6,    9,   12,   15},
+    },
+};
+
+// Packed RGB -> packed BGR
+alignas(16) const int8_t SWAP_RED_BLUE_MASKS[3][3][16] = {
+    {
+        {   2,    1,    0,    5,    4,    3,    8,    7,    6,   11,   10,    9,   14,   13,   12, -128},
+        {-128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128,    1},
+        {-128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128},
+    },
+    {
+        {-128,   15, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128},
+        {   0, -128,    4,    3,    2,    7,    6,    5,   10,    9,    8,   13,   12,   11, -128,   15},
+        {-128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128,    0, -128},
+    },
+    {
+        {-128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128},
+        {  14, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128},
+        {-128,    3,    2,    1,    6,    5,    4,    9,    8,    7,   12,   11,   10,   15,   14,   13},
+    },
+};
+
+LEDCUBE_TARGET_SSSE3 inline void permute48(const __m128i in[3], const int8_t (*masks)[3][16], __m128i out[3]) {
+    for (int o = 0; o < 3; ++o) {
+        __m128i value = _mm_setzero_si128();
+        for (int r = 0; r < 3; ++r) {
+            __m128i mask = _mm_load_si128(reinterpret_cast<const __m128i*>(masks[o][r]));
+            value = _mm_or_si128(value, _mm_shuffle_epi8(in[r], mask));
+        }
+        out[o] = value;
+    }
+}
+
+LEDCUBE_TARGET_SSSE3 inline __m128i div255(__m128i x) {
+    x = _mm_add_epi16(x, _mm_srli_epi16(x, 8));
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_set1_epi16(1)), 8);
+}
+
+LEDCUBE_TARGET_SSSE3 inline __m128i scale16(__m128i channels, __m128i brightness) {
+    return div255(_mm_add_epi16(_mm_mullo_epi16(channels, brightness), _mm_set1_epi16(127)));
+}
+
+LEDCUBE_TARGET_SSSE3 inline __m128i scale8(__m128i bytes, __m128i brightness) {
+    __m128i zero = _mm_setzero_si128();
+    __m128i low = scale16(_mm_unpacklo_epi8(bytes, zero), brightness);
+    __m128i high = scale16(_mm_unpackhi_epi8(bytes, zero), brightness);
+    return _mm_packus_epi16(low, high);
+}
+
+// Eight 16-bit channel triples -> eight 5-6-5 words
+LEDCUBE_TARGET_SSSE3 inline __m128i pack565(__m128i r, __m128i g, __m128i b, bool bigEndian) {
+    __m128i r5 = div255(_mm_mullo_epi16(r, _mm_set1_epi16(31)));
+    __m128i g6 = div255(_mm_mullo_epi16(g, _mm_set1_epi16(63)));
+    __m128i b5 = div255(_mm_mullo_epi16(b, _mm_set1_epi16(31)));
+    __m128i words = _mm_or_si128(_mm_or_si128(_mm_slli_epi16(r5, 11), _mm_slli_epi16(g6, 5)), b5);
+    if (bigEndian) {
+        words = _mm_or_si128(_mm_slli_epi16(words, 8), _mm_srli_epi16(words, 8));
+    }
+    return words;
+}
+
+LEDCUBE_TARGET_SSSE3 void scaleBytesSSSE3(const uint8_t* source, uint8_t* destination, size_t bytes, uint8_t brightness) {
+    __m128i scale = _mm_set1_epi16(brightness);
+    size_t i = 0;
+    for (; i + 16 <= bytes; i += 16) {
+        __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), scale8(value, scale));
+    }
+    scaleBytesScalar(source + i, destination + i, bytes - i, brightness);
+}
+
+LEDCUBE_TARGET_SSSE3 void swapRedBlueSSSE3(const uint8_t* source, uint8_t* destination, size_t pixels) {
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        const __m128i* in = reinterpret_cast<const __m128i*>(source + i * 3);
+        __m128i packed[3] = {_mm_loadu_si128(in), _mm_loadu_si128(in + 1), _mm_loadu_si128(in + 2)};
+        __m128i swapped[3];
+        permute48(packed, SWAP_RED_BLUE_MASKS, swapped);
+
+        __m128i* out = reinterpret_cast<__m128i*>(destination + i * 3);
+        _mm_storeu_si128(out, swapped[0]);
+        _mm_storeu_si128(out + 1, swapped[1]);
+        _mm_storeu_si128(out + 2, swapped[2]);
+    }
+    swapRedBlueScalar(source + i * 3, destination + i * 3, pixels - i);
+}
+
+LEDCUBE_TARGET_SSSE3 void toRGB565SSSE3(const uint8_t* source, uint8_t* destination, size_t pixels, uint8_t brightness, bool bigEndian) {
+    __m128i scale = _mm_set1_epi16(brightness);
+    __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        const __m128i* in = reinterpret_cast<const __m128i*>(source + i * 3);
+        __m128i packed[3] = {_mm_loadu_si128(in), _mm_loadu_si128(in + 1), _mm_loadu_si128(in + 2)};
+        __m128i planes[3];
+        permute48(packed, DEINTERLEAVE_MASKS, planes);
+        if (brightness != 255) {
+            for (auto& plane : planes) {
+                plane = scale8(plane, scale);
+            }
+        }
+
+        __m128i low = pack565(_mm_unpacklo_epi8(planes[0], zero), _mm_unpacklo_epi8(planes[1], zero),
+                              _mm_unpacklo_epi8(planes[2], zero), bigEndian);
+        __m128i high = pack565(_mm_unpackhi_epi8(planes[0], zero), _mm_unpackhi_epi8(planes[1], zero),
+                               _mm_unpackhi_epi8(planes[2], zero), bigEndian);
+
+        __m128i* out = reinterpret_cast<__m128i*>(destination + i * 2);
+        _mm_storeu_si128(out, low);
+        _mm_storeu_si128(out + 1, high);
+    }
+    toRGB565Scalar(source + i * 3, destination + i * 2, pixels - i, brightness, bigEndian);
+}
+
+const PixelKernels SSSE3_KERNELS = {"ssse3", scaleBytesSSSE3, swapRedBlueSSSE3, toRGB565SSSE3};
+
+// Lane 0 holds pixels [0, 16) and lane 1 pixels [16, 32) of a 32-pixel block
+LEDCUBE_TARGET_AVX2 inline void load96(const uint8_t* source, __m256i packed[3]) {
+    const __m128i* in = reinterpret_cast<const __m128i*>(source);
+    for (int r = 0; r < 3; ++r) {
+        packed[r] = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(in + r)),
+                                            _mm_loadu_si128(in + 3 + r), 1);
+    }
+}
+
+LEDCUBE_TARGET_AVX2 inline void store96(uint8_t* destination, const __m256i packed[3]) {
+    __m128i* out = reinterpret_cast<__m128i*>(destination);
+    for (int r = 0; r < 3; ++r) {
+        _mm_storeu_si128(out + r, _mm256_castsi256_si128(packed[r]));
+        _mm_storeu_si128(out + 3 + r, _mm256_extracti128_si256(packed[r], 1));
+    }
+}
+
+LEDCUBE_TARGET_AVX2 inline void permute96(const __m256i in[3], const int8_t (*masks)[3][16], __m256i out[3]) {
+    for (int o = 0; o < 3; ++o) {
+        __m256i value = _mm256_setzero_si256();
+        for (int r = 0; r < 3; ++r) {
+            __m256i mask = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(masks[o][r])));
+            value = _mm256_or_si256(value, _mm256_shuffle_epi8(in[r], mask));
+        }
+        out[o] = value;
+    }
+}
+
+LEDCUBE_TARGET_AVX2 inline __m256i div255(__m256i x) {
+    x = _mm256_add_epi16(x, _mm256_srli_epi16(x, 8));
+    return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_set1_epi16(1)), 8);
+}
+
+LEDCUBE_TARGET_AVX2 inline __m256i scale16(__m256i channels, __m256i brightness) {
+    return div255(_mm256_add_epi16(_mm256_mullo_epi16(channels, brightness), _mm256_set1_epi16(127)));
+}
+
+LEDCUBE_TARGET_AVX2 inline __m256i scale8(__m256i bytes, __m256i brightness) {
+    __m256i zero = _mm256_setzero_si256();
+    __m256i low = scale16(_mm256_unpacklo_epi8(bytes, zero), brightness);
+    __m256i high = scale16(_mm256_unpackhi_epi8(bytes, zero), brightness);
+    return _mm256_packus_epi16(low, high);
+}
+
+LEDCUBE_TARGET_AVX2 inline __m256i pack565(__m256i r, __m256i g, __m256i b, bool bigEndian) {
+    __m256i r5 = div255(_mm256_mullo_epi16(r, _mm256_set1_epi16(31)));
+    __m256i g6 = div255(_mm256_mullo_epi16(g, _mm256_set1_epi16(63)));
+    __m256i b5 = div255(_mm256_mullo_epi16(b, _mm256_set1_epi16(31)));
+    __m256i words = _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi16(r5, 11), _mm256_slli_epi16(g6, 5)), b5);
+    if (bigEndian) {
+        words = _mm256_or_si256(_mm256_slli_epi16(words, 8), _mm256_srli_epi16(words, 8));
+    }
+    return words;
+}
+
+LEDCUBE_TARGET_AVX2 void scaleBytesAVX2(const uint8_t* source, uint8_t* destination, size_t bytes, uint8_t brightness) {
+    __m256i scale = _mm256_set1_epi16(brightness);
+    size_t i = 0;
+    for (; i + 32 <= bytes; i += 32) {
+        __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), scale8(value, scale));
+    }
+    scaleBytesScalar(source + i, destination + i, bytes - i, brightness);
+}
+
+LEDCUBE_TARGET_AVX2 void swapRedBlueAVX2(const uint8_t* source, uint8_t* destination, size_t pixels) {
+    size_t i = 0;
+    for (; i + 32 <= pixels; i += 32) {
+        __m256i packed[3];
+        __m256i swapped[3];
+        load96(source + i * 3, packed);
+        permute96(packed, SWAP_RED_BLUE_MASKS, swapped);
+        store96(destination + i * 3, swapped);
+    }
+    swapRedBlueScalar(source + i * 3, destination + i * 3, pixels - i);
+}
+
+LEDCUBE_TARGET_AVX2 void toRGB565AVX2(const uint8_t* source, uint8_t* destination, size_t pixels, uint8_t brightness, bool bigEndian) {
+    __m256i scale = _mm256_set1_epi16(brightness);
+    __m256i zero = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= pixels; i += 32) {
+        __m256i packed[3];
+        __m256i planes[3];
+        load96(source + i * 3, packed);
+        permute96(packed, DEINTERLEAVE_MASKS, planes);
+        if (brightness != 255) {
+            for (auto& plane : planes) {
+                plane = scale8(plane, scale);
+            }
+        }
+
+        // Unpacking is per lane: low = pixels [0, 8) and [16, 24),
+        // high = pixels [8, 16) and [24, 32)
+        __m256i low = pack565(_mm256_unpacklo_epi8(planes[0], zero), _mm256_unpacklo_epi8(planes[1], zero),
+                              _mm256_unpacklo_epi8(planes[2], zero), bigEndian);
+        __m256i high = pack565(_mm256_unpackhi_epi8(planes[0], zero), _mm256_unpackhi_epi8(planes[1], zero),
+                               _mm256_unpackhi_epi8(planes[2], zero), bigEndian);
+
+        __m256i* out = reinterpret_cast<__m256i*>(destination + i * 2);
+        _mm256_storeu_si256(out, _mm256_permute2x128_si256(low, high, 0x20));
+        _mm256_storeu_si256(out + 1, _mm256_permute2x128_si256(low, high, 0x31));
+    }
+    toRGB565Scalar(source + i * 3, destination + i * 2, pixels - i, brightness, bigEndian);
+}
+
+const PixelKernels AVX2_KERNELS = {"avx2", scaleBytesAVX2, swapRedBlueAVX2, toRGB565AVX2};
+
+#endif // LEDCUBE_PIXEL_X86
+
+#if defined(LEDCUBE_PIXEL_NEON)
+
+// NEON -----------------------------------------------------------------------
+//
+// vld3q/vst3q deinterleave 16 pixels per iteration in hardware; the
+// arithmetic matches the x86 kernels.
+
+inline uint16x8_t div255(uint16x8_t x) {
+    x = vaddq_u16(x, vshrq_n_u16(x, 8));
+    return vshrq_n_u16(vaddq_u16(x, vdupq_n_u16(1)), 8);
+}
+
+inline uint8x16_t scale8(uint8x16_t bytes, uint8x8_t brightness) {
+    uint16x8_t round = vdupq_n_u16(127);
+    uint16x8_t low = div255(vaddq_u16(vmull_u8(vget_low_u8(bytes), brightness), round));
+    uint16x8_t high = div255(vaddq_u16(vmull_u8(vget_high_u8(bytes), brightness), round));
+    return vcombine_u8(vmovn_u16(low), vmovn_u16(high));
+}
+
+inline uint16x8_t pack565(uint8x8_t r, uint8x8_t g, uint8x8_t b) {
+    uint16x8_t r5 = div255(vmull_u8(r, vdup_n_u8(31)));
+    uint16x8_t g6 = div255(vmull_u8(g, vdup_n_u8(63)));
+    uint16x8_t b5 = div255(vmull_u8(b, vdup_n_u8(31)));
+    return vorrq_u16(vorrq_u16(vshlq_n_u16(r5, 11), vshlq_n_u16(g6, 5)), b5);
+}
+
+void scaleBytesNEON(const uint8_t* source, uint8_t* destination, size_t bytes, uint8_t brightness) {
+    uint8x8_t scale = vdup_n_u8(brightness);
+    size_t i = 0;
+    for (; i + 16 <= bytes; i += 16) {
+        vst1q_u8(destination + i, scale8(vld1q_u8(source + i), scale));
+    }
+    scaleBytesScalar(source + i, destination + i, bytes - i, brightness);
+}
+
+void swapRedBlueNEON(const uint8_t* source, uint8_t* destination, size_t pixels) {
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        uint8x16x3_t planes = vld3q_u8(source + i * 3);
+        uint8x16_t red = planes.val[0];
+        planes.val[0] = planes.val[2];
+        planes.val[2] = red;
+        vst3q_u8(destination + i * 3, planes);
+    }
+    swapRedBlueScalar(source + i * 3, destination + i * 3, pixels - i);
+}
+
+void toRGB565NEON(const uint8_t* source, uint8_t* destination, size_t pixels, uint8_t brightness, bool bigEndian) {
+    uint8x8_t scale = vdup_n_u8(brightness);
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        uint8x16x3_t planes = vld3q_u8(source + i * 3);
+        if (brightness != 255) {
+            for (auto& plane : planes.val) {
+                plane = scale8(plane, scale);
+            }
+        }
+
+        uint8x16_t low = vreinterpretq_u8_u16(pack565(vget_low_u8(planes.val[0]), vget_low_u8(planes.val[1]),
+                                                      vget_low_u8(planes.val[2])));
+        uint8x16_t high = vreinterpretq_u8_u16(pack565(vget_high_u8(planes.val[0]), vget_high_u8(planes.val[1]),
+                                                       vget_high_u8(planes.val[2])));
+        if (bigEndian) {
+            low = vrev16q_u8(low);
+            high = vrev16q_u8(high);
+        }
+        vst1q_u8(destination + i * 2, low);
+        vst1q_u8(destination + i * 2 + 16, high);
+    }
+    toRGB565Scalar(source + i * 3, destination + i * 2, pixels - i, brightness, bigEndian);
+}
+
+const PixelKernels NEON_KERNELS = {"neon", scaleBytesNEON, swapRedBlueNEON, toRGB565NEON};
+
+#endif // LEDCUBE_PIXEL_NEON
+
+// Best first
+std::vector<const PixelKernels*> supportedKernels() {
+    std::vector<const PixelKernels*> kernels;
+#if defined(LEDCUBE_PIXEL_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        kernels.push_back(&AVX2_KERNELS);
+    }
+    if (__builtin_cpu_supports("ssse3")) {
+        kernels.push_back(&SSSE3_KERNELS);
+    }
+#elif defined(LEDCUBE_PIXEL_NEON)
+    // NEON is part of the baseline wherever the compiler enables it
+    kernels.push_back(&NEON_KERNELS);
+#endif
+    kernels.push_back(&SCALAR_KERNELS);
+    return kernels;
+}
+
+std::atomic<const PixelKernels*>& activeKernels() {
+    static std::atomic<const PixelKernels*> kernels{supportedKernels().front()};
+    return kernels;
+}
+
+} // namespace
+
+size_t bytesPerPixel(PixelFormat format) {
+    switch (format) {
+        case PixelFormat::RGB888:
+        case PixelFormat::BGR888:
+            return 3;
+        case PixelFormat::RGB565BE:
+        case PixelFormat::RGB565LE:
+            return 2;
+    }
+    return 0;
+}
+
+void convertPixels(const Color* source, size_t count, uint8_t* destination,
+                   PixelFormat format, uint8_t brightness) {
+    const PixelKernels* kernels = activeKernels().load(std::memory_order_relaxed);
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(source);
+
+    switch (format) {
+        case PixelFormat::RGB888:
+            if (brightness == 255) {
+                std::memcpy(destination, bytes, count * 3);
+            } else {
+                kernels->scaleBytes(bytes, destination, count * 3, brightness);
+            }
+            break;
+        case PixelFormat::BGR888:
+            kernels->swapRedBlue(bytes, destination, count);
+            if (brightness != 255) {
+                kernels->scaleBytes(destination, destination, count * 3, brightness);
+            }
+            break;
+        case PixelFormat::RGB565BE:
+        case PixelFormat::RGB565LE:
+            kernels->toRGB565(bytes, destination, count, brightness, format == PixelFormat::RGB565BE);
+            break;
+    }
+}
+
+const char* getPixelKernel() {
+    return activeKernels().load(std::memory_order_relaxed)->name;
+}
+
+std::vector<std::string> getAvailablePixelKernels() {
+    std::vector<std::string> names;
+    for (const PixelKernels* kernels : supportedKernels()) {
+        names.push_back(kernels->name);
+    }
+    return names;
+}
+
+bool setPixelKernel(const std::string& name) {
+    for (const PixelKernels* kernels : supportedKernels()) {
+        if (name == kernels->name) {
+            activeKernels().store(kernels, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace LEDCube
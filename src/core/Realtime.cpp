@@ -0,0 +1,131 @@
+#include "core/Realtime.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <time.h>
+
+namespace LEDCube {
+
+namespace {
+
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield");
+#endif
+}
+
+} // namespace
+
+bool Realtime::setPriority(int priority) {
+    sched_param param{};
+    param.sched_priority = priority;
+    int error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (error != 0) {
+        std::cerr << "Realtime: Cannot set SCHED_FIFO priority " << priority << ": "
+                  << std::strerror(error) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool Realtime::pinToCpu(int cpu) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    int error = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    if (error != 0) {
+        std::cerr << "Realtime: Cannot pin thread to CPU " << cpu << ": " << std::strerror(error) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool Realtime::pinToCpus(const std::vector<int>& cpuList) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    for (int cpu : cpuList) {
+        CPU_SET(cpu, &cpus);
+    }
+    int error = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    if (error != 0) {
+        std::cerr << "Realtime: Cannot pin thread to " << cpuList.size() << " CPUs: " << std::strerror(error) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool Realtime::lockMemory() {
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        std::cerr << "Realtime: Cannot lock memory: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool Realtime::apply(const RealtimeOptions& options) {
+    bool ok = true;
+    if (options.lockMemory) {
+        ok = lockMemory() && ok;
+    }
+    if (options.cpu >= 0) {
+        ok = pinToCpu(options.cpu) && ok;
+    }
+    if (options.priority > 0) {
+        ok = setPriority(options.priority) && ok;
+    }
+    return ok;
+}
+
+int Realtime::getCpuCount() {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void Realtime::waitUntil(std::chrono::steady_clock::time_point deadline, std::chrono::nanoseconds spinWindow) {
+    auto wakeTime = deadline - spinWindow;
+    if (std::chrono::steady_clock::now() < wakeTime) {
+        auto sinceEpoch = std::chrono::duration_cast<std::chrono::nanoseconds>(wakeTime.time_since_epoch()).count();
+        timespec wake;
+        wake.tv_sec = static_cast<time_t>(sinceEpoch / 1000000000);
+        wake.tv_nsec = static_cast<long>(sinceEpoch % 1000000000);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, nullptr) == EINTR) {
+        }
+    }
+
+    while (std::chrono::steady_clock::now() < deadline) {
+        cpuRelax();
+    }
+}
+
+void JitterMonitor::record(std::chrono::steady_clock::time_point deadline,
+                           std::chrono::steady_clock::time_point actual,
+                           std::chrono::nanoseconds period) {
+    auto lateness = std::chrono::duration_cast<std::chrono::nanoseconds>(actual - deadline);
+    uint64_t latenessNs = lateness.count() > 0 ? static_cast<uint64_t>(lateness.count()) : 0;
+
+    histogram.record(latenessNs);
+    if (lateness >= period) {
+        overruns.store(overruns.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+    if (latenessNs > maxLateness.load(std::memory_order_relaxed)) {
+        maxLateness.store(latenessNs, std::memory_order_relaxed);
+    }
+}
+
+JitterStats JitterMonitor::getStats() const {
+    JitterStats stats;
+    stats.count = histogram.getTotalCount();
+    stats.overruns = overruns.load(std::memory_order_relaxed);
+    stats.p50Us = histogram.getPercentile(0.50) / 1e3;
+    stats.p99Us = histogram.getPercentile(0.99) / 1e3;
+    stats.maxUs = maxLateness.load(std::memory_order_relaxed) / 1e3;
+    return stats;
+}
+
+} // namespace LEDCube
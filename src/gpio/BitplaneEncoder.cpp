@@ -0,0 +1,171 @@
+#include "gpio/BitplaneEncoder.h"
+#include <algorithm>
+
+namespace LEDCube {
+
+namespace {
+
+// Packed R/G/B levels of a pixel, each in MAX_BIT_DEPTH bits
+inline uint64_t packLevels(const Color& color, const uint16_t* red, const uint16_t* green, const uint16_t* blue) {
+    return static_cast<uint64_t>(red[color.r]) |
+           static_cast<uint64_t>(green[color.g]) << BitplaneEncoder::MAX_BIT_DEPTH |
+           static_cast<uint64_t>(blue[color.b]) << (2 * BitplaneEncoder::MAX_BIT_DEPTH);
+}
+
+// 3-bit RGB value of one plane of packed levels
+inline uint32_t planeBits(uint64_t levels, int plane) {
+    uint64_t bits = levels >> plane;
+    return static_cast<uint32_t>((bits & 1) | ((bits >> (BitplaneEncoder::MAX_BIT_DEPTH - 1)) & 2) |
+                                 ((bits >> (2 * BitplaneEncoder::MAX_BIT_DEPTH - 2)) & 4));
+}
+
+} // namespace
+
+BitplaneEncoder::BitplaneEncoder(int bitDepth, const PixelMapper& mapper)
+    : chainLength(0), dataMask(0), bitDepth(MAX_BIT_DEPTH) {
+    setMapper(mapper);
+    setBitDepth(bitDepth);
+}
+
+void BitplaneEncoder::setLayout(const ChainLayout& layout) {
+    PixelMapper remapped = mapper;
+    remapped.setLayout(layout);
+    setMapper(remapped);
+}
+
+void BitplaneEncoder::setMapper(const PixelMapper& newMapper) {
+    mapper = newMapper;
+    const ChainLayout& layout = mapper.getLayout();
+    chainLength = layout.getChainLength();
+    dataMask = layout.getDataMask();
+
+    // The pins of a chain need not be adjacent, so each 3-bit pixel value
+    // is looked up rather than shifted into place
+    for (int chain = 0; chain < ChainLayout::MAX_CHAINS; ++chain) {
+        const ChainPins& pins = ChainLayout::PINS[chain];
+        for (int rgb = 0; rgb < 8; ++rgb) {
+            pinBits[chain][0][rgb] = ((rgb & 1) ? 1u << pins.r1 : 0) | ((rgb & 2) ? 1u << pins.g1 : 0) |
+                                     ((rgb & 4) ? 1u << pins.b1 : 0);
+            pinBits[chain][1][rgb] = ((rgb & 1) ? 1u << pins.r2 : 0) | ((rgb & 2) ? 1u << pins.g2 : 0) |
+                                     ((rgb & 4) ? 1u << pins.b2 : 0);
+        }
+    }
+    allocatePlanes();
+}
+
+void BitplaneEncoder::setBitDepth(int bits) {
+    bitDepth = std::max(MIN_BIT_DEPTH, std::min(MAX_BIT_DEPTH, bits));
+    allocatePlanes();
+    colors.update(colors.getSettings(), bitDepth);
+}
+
+void BitplaneEncoder::allocatePlanes() {
+    planes.assign(static_cast<size_t>(bitDepth) * ROW_PAIRS * chainLength, 0);
+}
+
+void BitplaneEncoder::setColorSettings(const ColorSettings& settings) {
+    // Gamma, white balance and brightness are folded into the 8-bit ->
+    // bitDepth expansion, so they cost nothing per pixel and dimming keeps
+    // the full bit depth
+    colors.update(settings, bitDepth);
+}
+
+void BitplaneEncoder::setBrightness(double level) {
+    ColorSettings settings = colors.getSettings();
+    settings.brightness = std::max(0.0, std::min(1.0, level));
+    setColorSettings(settings);
+}
+
+uint32_t BitplaneEncoder::encode(const MatrixBuffer& buffer, bool full) {
+    if (full && buffer.getLayout() == BufferLayout::ScanOrder && mapper.isScanNative()) {
+        encodeScanOrder(buffer);
+        return ALL_ROW_PAIRS;
+    }
+    
+    uint32_t rowPairs = 0;
+    for (int face = 0; face < CUBE_DEPTH; ++face) {
+        uint64_t rows = full ? ALL_ROWS_DIRTY : mapper.getPanelRows(face, buffer.getDirtyRows(face));
+        rowPairs |= static_cast<uint32_t>(rows | rows >> ROW_PAIRS);
+        while (rows != 0) {
+            int panelY = __builtin_ctzll(rows);
+            rows &= rows - 1;
+            encodeRow(buffer, face, panelY);
+        }
+    }
+    return rowPairs;
+}
+
+void BitplaneEncoder::encodeRow(const MatrixBuffer& buffer, int face, int panelY) {
+    const Color* pixels = buffer.getBuffer().data();
+    const uint16_t* sources = mapper.getRowSources(face, panelY, buffer.getLayout());
+
+    // One panel row, gathered through the mapper and corrected through the
+    // face's color tables -> its 3 bits of every plane
+    const uint16_t* red = colors.getTable(face, 0);
+    const uint16_t* green = colors.getTable(face, 1);
+    const uint16_t* blue = colors.getTable(face, 2);
+    uint64_t rgb[CUBE_SIZE];
+    for (int x = 0; x < CUBE_SIZE; ++x) {
+        rgb[x] = packLevels(pixels[sources[x]], red, green, blue);
+    }
+
+    // Rows y and y + 32 share words, and so do the other chains, so only
+    // this chain's half is replaced
+    const PanelSlot& slot = mapper.getLayout().faces[face];
+    bool lowerHalf = panelY >= ROW_PAIRS;
+    const std::array<uint32_t, 8>& bitsFor = pinBits[slot.chain][lowerHalf];
+    const ChainPins& pins = ChainLayout::PINS[slot.chain];
+    uint32_t keep = ~(lowerHalf ? pins.lowerMask() : pins.upperMask());
+    int rowPair = panelY % ROW_PAIRS;
+    int firstColumn = chainLength - (slot.position + 1) * CUBE_SIZE;
+
+    for (int plane = 0; plane < bitDepth; ++plane) {
+        uint32_t* words = planes.data() + (static_cast<size_t>(plane) * ROW_PAIRS + rowPair) * chainLength + firstColumn;
+        for (int x = 0; x < CUBE_SIZE; ++x) {
+            words[x] = (words[x] & keep) | bitsFor[planeBits(rgb[x], plane)];
+        }
+    }
+}
+
+void BitplaneEncoder::encodeScanOrder(const MatrixBuffer& buffer) {
+    // The buffer holds both halves of every row pair side by side in clock
+    // order, so the frame is read front to back and each word is written
+    // once instead of merged per half
+    const Color* pixels = buffer.getBuffer().data();
+    const std::array<uint32_t, 8>& upperBits = pinBits[0][0];
+    const std::array<uint32_t, 8>& lowerBits = pinBits[0][1];
+
+    for (int rowPair = 0; rowPair < ROW_PAIRS; ++rowPair) {
+        for (int panel = 0; panel < CUBE_DEPTH; ++panel) {
+            int face = CUBE_DEPTH - 1 - panel;
+            const uint16_t* red = colors.getTable(face, 0);
+            const uint16_t* green = colors.getTable(face, 1);
+            const uint16_t* blue = colors.getTable(face, 2);
+            const Color* source = pixels + (static_cast<size_t>(rowPair) * chainLength + panel * CUBE_SIZE) * 2;
+
+            uint64_t upper[CUBE_SIZE];
+            uint64_t lower[CUBE_SIZE];
+            for (int x = 0; x < CUBE_SIZE; ++x) {
+                upper[x] = packLevels(source[2 * x], red, green, blue);
+                lower[x] = packLevels(source[2 * x + 1], red, green, blue);
+            }
+
+            for (int plane = 0; plane < bitDepth; ++plane) {
+                uint32_t* words = planes.data() + (static_cast<size_t>(plane) * ROW_PAIRS + rowPair) * chainLength + panel * CUBE_SIZE;
+                for (int x = 0; x < CUBE_SIZE; ++x) {
+                    words[x] = upperBits[planeBits(upper[x], plane)] | lowerBits[planeBits(lower[x], plane)];
+                }
+            }
+        }
+    }
+}
+
+uint32_t BitplaneEncoder::rowAddressBits(int rowPair) {
+    return ((rowPair & 0x01) ? 1u << GPIOPins::ADDR_A : 0) |
+           ((rowPair & 0x02) ? 1u << GPIOPins::ADDR_B : 0) |
+           ((rowPair & 0x04) ? 1u << GPIOPins::ADDR_C : 0) |
+           ((rowPair & 0x08) ? 1u << GPIOPins::ADDR_D : 0) |
+           ((rowPair & 0x10) ? 1u << GPIOPins::ADDR_E : 0);
+}
+
+} // namespace LEDCube
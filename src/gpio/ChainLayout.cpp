@@ -0,0 +1,73 @@
+#include "gpio/ChainLayout.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace LEDCube {
+
+ChainLayout::ChainLayout() {
+    for (int face = 0; face < CUBE_DEPTH; ++face) {
+        faces[face] = PanelSlot{0, face};
+    }
+}
+
+ChainLayout ChainLayout::interleaved(int chainCount) {
+    ChainLayout layout;
+    layout.chainCount = chainCount;
+    if (chainCount > 0) {
+        for (int face = 0; face < CUBE_DEPTH; ++face) {
+            layout.faces[face] = PanelSlot{face % chainCount, face / chainCount};
+        }
+    }
+    layout.validate();
+    return layout;
+}
+
+void ChainLayout::validate() const {
+    if (chainCount < 1 || chainCount > MAX_CHAINS) {
+        throw std::invalid_argument("Chain count must be 1 to " + std::to_string(MAX_CHAINS) +
+                                    ", got " + std::to_string(chainCount));
+    }
+    for (int face = 0; face < CUBE_DEPTH; ++face) {
+        const PanelSlot& slot = faces[face];
+        if (slot.chain < 0 || slot.chain >= chainCount || slot.position < 0 || slot.position >= CUBE_DEPTH) {
+            throw std::invalid_argument("Face " + std::to_string(face) + " is assigned to chain " +
+                                        std::to_string(slot.chain) + " position " + std::to_string(slot.position) +
+                                        ", outside the layout");
+        }
+        for (int other = 0; other < face; ++other) {
+            if (faces[other].chain == slot.chain && faces[other].position == slot.position) {
+                throw std::invalid_argument("Faces " + std::to_string(other) + " and " + std::to_string(face) +
+                                            " share chain " + std::to_string(slot.chain) + " position " +
+                                            std::to_string(slot.position));
+            }
+        }
+    }
+}
+
+int ChainLayout::getPanelsPerChain() const {
+    int panels = 0;
+    for (const PanelSlot& slot : faces) {
+        panels = std::max(panels, slot.position + 1);
+    }
+    return panels;
+}
+
+int ChainLayout::getFaceAt(int chain, int position) const {
+    for (int face = 0; face < CUBE_DEPTH; ++face) {
+        if (faces[face].chain == chain && faces[face].position == position) {
+            return face;
+        }
+    }
+    return -1;
+}
+
+uint32_t ChainLayout::getDataMask() const {
+    uint32_t mask = 0;
+    for (int chain = 0; chain < chainCount && chain < MAX_CHAINS; ++chain) {
+        mask |= PINS[chain].mask();
+    }
+    return mask;
+}
+
+} // namespace LEDCube
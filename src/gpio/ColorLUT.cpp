@@ -0,0 +1,41 @@
+#include "gpio/ColorLUT.h"
+#include <algorithm>
+#include <cmath>
+
+namespace LEDCube {
+
+ColorLUT::ColorLUT() : bitDepth(8) {
+    rebuild();
+}
+
+void ColorLUT::update(const ColorSettings& newSettings, int newBitDepth) {
+    if (newSettings == settings && newBitDepth == bitDepth) {
+        return;
+    }
+    settings = newSettings;
+    bitDepth = newBitDepth;
+    rebuild();
+}
+
+void ColorLUT::rebuild() {
+    // The gamma curve is shared; the gains differ per face and channel
+    double gamma = settings.gamma > 0.0 ? settings.gamma : 1.0;
+    std::array<double, 256> linear;
+    for (int value = 0; value < 256; ++value) {
+        linear[value] = std::pow(value / 255.0, gamma);
+    }
+
+    double maxLevel = static_cast<double>((1 << bitDepth) - 1);
+    double brightness = std::max(0.0, std::min(1.0, settings.brightness));
+    for (int face = 0; face < CUBE_DEPTH; ++face) {
+        for (int channel = 0; channel < 3; ++channel) {
+            double gain = std::max(0.0, settings.whiteBalance[channel] * settings.faceCalibration[face][channel] * brightness);
+            uint16_t* table = tables.data() + (face * 3 + channel) * 256;
+            for (int value = 0; value < 256; ++value) {
+                table[value] = static_cast<uint16_t>(std::lround(std::min(1.0, linear[value] * gain) * maxLevel));
+            }
+        }
+    }
+}
+
+} // namespace LEDCube
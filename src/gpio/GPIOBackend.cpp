@@ -0,0 +1,101 @@
+#include "gpio/GPIOBackend.h"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace LEDCube {
+
+void GPIOBackend::delayNanoseconds(uint64_t nanoseconds) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::nanoseconds(nanoseconds);
+    while (std::chrono::steady_clock::now() < deadline) {
+    }
+}
+
+MappedGPIOBackend::MappedGPIOBackend()
+    : registers(nullptr), ownedRegisters(BLOCK_SIZE / sizeof(uint32_t), 0),
+      mapping(nullptr), fd(-1), name("memory") {
+    registers = ownedRegisters.data();
+}
+
+MappedGPIOBackend::MappedGPIOBackend(const std::string& path, off_t offset, bool createFile)
+    : registers(nullptr), mapping(nullptr), fd(-1), name(path) {
+    fd = ::open(path.c_str(), O_RDWR | O_SYNC | O_CLOEXEC | (createFile ? O_CREAT : 0), 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open " + path + ": " + std::strerror(errno));
+    }
+
+    // A regular file stands in for the register block; make it big enough
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) &&
+        info.st_size < static_cast<off_t>(offset + BLOCK_SIZE) &&
+        ftruncate(fd, offset + BLOCK_SIZE) != 0) {
+        int error = errno;
+        ::close(fd);
+        throw std::runtime_error("Cannot size " + path + ": " + std::strerror(error));
+    }
+
+    mapping = mmap(nullptr, BLOCK_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, offset);
+    if (mapping == MAP_FAILED) {
+        int error = errno;
+        ::close(fd);
+        throw std::runtime_error("Cannot map " + path + ": " + std::strerror(error));
+    }
+    registers = static_cast<volatile uint32_t*>(mapping);
+}
+
+MappedGPIOBackend::MappedGPIOBackend(volatile uint32_t* registers)
+    : registers(registers), mapping(nullptr), fd(-1), name("external memory") {
+}
+
+MappedGPIOBackend::~MappedGPIOBackend() {
+    if (mapping) {
+        munmap(mapping, BLOCK_SIZE);
+    }
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+
+void MappedGPIOBackend::write(uint64_t setMask, uint64_t clearMask) {
+    // Writing 0 to a SET/CLR bit leaves that pin alone, so untouched banks
+    // are skipped rather than written
+    uint32_t setLow = static_cast<uint32_t>(setMask);
+    uint32_t setHigh = static_cast<uint32_t>(setMask >> 32);
+    uint32_t clearLow = static_cast<uint32_t>(clearMask);
+    uint32_t clearHigh = static_cast<uint32_t>(clearMask >> 32);
+
+    if (setLow) {
+        registers[GPSET0] = setLow;
+    }
+    if (setHigh) {
+        registers[GPSET0 + 1] = setHigh;
+    }
+    if (clearLow) {
+        registers[GPCLR0] = clearLow;
+    }
+    if (clearHigh) {
+        registers[GPCLR0 + 1] = clearHigh;
+    }
+}
+
+uint64_t MappedGPIOBackend::read() const {
+    return static_cast<uint64_t>(registers[GPLEV0]) | (static_cast<uint64_t>(registers[GPLEV0 + 1]) << 32);
+}
+
+void MappedGPIOBackend::setPinMode(int pin, int mode) {
+    if (pin < 0 || pin >= PIN_COUNT) {
+        return;
+    }
+
+    // Three function-select bits per pin, ten pins per register
+    volatile uint32_t& select = registers[GPFSEL0 + pin / 10];
+    int shift = (pin % 10) * 3;
+    select = (select & ~(7u << shift)) | ((static_cast<uint32_t>(mode) & 7u) << shift);
+}
+
+} // namespace LEDCube
@@ -5,8 +5,8 @@
 
 namespace LEDCube {
 
-GPIOController::GPIOController() : initialized(false) {
-    pinStates.resize(64, false);
+GPIOController::GPIOController(std::unique_ptr<GPIOBackend> backend)
+    : initialized(false), backend(std::move(backend)), pinStates(0), outputPins(0), chainPins(0), spiUsed(false) {
     pinModes.resize(64, 0);
 }
 
@@ -21,16 +21,19 @@ bool GPIOController::initialize() {
     
     std::cout << "GPIO Controller: Initializing..." << std::endl;
     
-    // In a real implementation, this would initialize WiringPi
-    // For now, we'll just simulate the initialization
-    
     try {
-        initializePins();
+        if (!backend) {
+            backend = std::make_unique<MappedGPIOBackend>();
+        }
+        std::cout << "GPIO Controller: Using " << backend->getName() << " backend" << std::endl;
+        
         initialized = true;
+        initializePins();
         std::cout << "GPIO Controller: Initialized successfully" << std::endl;
         return true;
     } catch (const std::exception& e) {
         std::cerr << "GPIO Controller: Failed to initialize: " << e.what() << std::endl;
+        initialized = false;
         return false;
     }
 }
@@ -58,8 +61,9 @@ void GPIOController::setPin(int pin, bool state) {
     }
     
     if (initialized) {
-        // In real implementation: digitalWrite(pin, state ? HIGH : LOW);
-        pinStates[pin] = state;
+        uint64_t bit = uint64_t(1) << pin;
+        backend->write(state ? bit : 0, state ? 0 : bit);
+        pinStates = state ? (pinStates | bit) : (pinStates & ~bit);
     }
 }
 
@@ -68,7 +72,7 @@ bool GPIOController::getPin(int pin) const {
         return false;
     }
     
-    return pinStates[pin];
+    return (pinStates >> pin) & 1;
 }
 
 void GPIOController::setPinMode(int pin, int mode) {
@@ -78,9 +82,21 @@ void GPIOController::setPinMode(int pin, int mode) {
     }
     
     if (initialized) {
-        // In real implementation: pinMode(pin, mode);
+        backend->setPinMode(pin, mode);
         pinModes[pin] = mode;
+        uint64_t bit = uint64_t(1) << pin;
+        outputPins = mode == 1 ? (outputPins | bit) : (outputPins & ~bit);
+    }
+}
+
+void GPIOController::writeBits(uint32_t value, uint32_t mask) {
+    if (!initialized) {
+        return;
     }
+    
+    // One store each to the set and clear registers
+    backend->write(value & mask, ~value & mask);
+    pinStates = (pinStates & ~uint64_t(mask)) | (value & mask);
 }
 
 void GPIOController::spiWrite(const std::vector<uint8_t>& data) {
@@ -88,8 +104,6 @@ void GPIOController::spiWrite(const std::vector<uint8_t>& data) {
         return;
     }
     
-    // In real implementation, this would write SPI data
-    // For now, just simulate the timing
     for (uint8_t byte : data) {
         spiWriteByte(byte);
     }
@@ -100,9 +114,18 @@ void GPIOController::spiWriteByte(uint8_t byte) {
         return;
     }
     
-    // In real implementation, this would write a single byte via SPI
-    // For now, just simulate the timing
-    std::this_thread::sleep_for(std::chrono::microseconds(10));
+    // Bit-banged SPI mode 0, MSB first, on the data and clock pins
+    const uint32_t dataBit = 1u << GPIOPins::DATA_PIN;
+    const uint32_t clockBit = 1u << GPIOPins::CLOCK_PIN;
+    if (chainPins & dataBit) {
+        return;
+    }
+    spiUsed = true;
+    for (int bit = 7; bit >= 0; --bit) {
+        writeBits((byte >> bit) & 1 ? dataBit : 0, dataBit | clockBit);
+        writeBits(clockBit, clockBit);
+    }
+    writeBits(0, clockBit);
 }
 
 void GPIOController::delayMicroseconds(unsigned int microseconds) {
@@ -113,6 +136,13 @@ void GPIOController::delayMilliseconds(unsigned int milliseconds) {
     std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
 }
 
+void GPIOController::delayNanoseconds(unsigned int nanoseconds) {
+    // The backend owns time: hardware spins, a simulator advances its clock
+    if (backend) {
+        backend->delayNanoseconds(nanoseconds);
+    }
+}
+
 void GPIOController::setLayer(int layer) {
     if (!initialized) {
         return;
@@ -123,6 +153,7 @@ void GPIOController::setLayer(int layer) {
     setPin(GPIOPins::ADDR_B, (layer & 0x02) != 0);
     setPin(GPIOPins::ADDR_C, (layer & 0x04) != 0);
     setPin(GPIOPins::ADDR_D, (layer & 0x08) != 0);
+    setPin(GPIOPins::ADDR_E, (layer & 0x10) != 0);
 }
 
 void GPIOController::enableOutput(bool enable) {
@@ -138,14 +169,14 @@ void GPIOController::latchData() {
         return;
     }
     
-    // Latch the data into the matrix
+    // Latch the data into the matrix; a pin write is already longer than
+    // the panel's minimum latch pulse
     setPin(GPIOPins::LATCH_PIN, true);
-    delayMicroseconds(1);
     setPin(GPIOPins::LATCH_PIN, false);
 }
 
 void GPIOController::resetMatrix() {
-    if (!initialized) {
+    if (!initialized || (chainPins >> GPIOPins::RESET_PIN) & 1) {
         return;
     }
     
@@ -154,16 +185,21 @@ void GPIOController::resetMatrix() {
     setPin(GPIOPins::RESET_PIN, false);
 }
 
+bool GPIOController::setChainPins(uint64_t mask) {
+    if (spiUsed && (mask >> GPIOPins::DATA_PIN) & 1) {
+        return false;
+    }
+    chainPins = mask;
+    return true;
+}
+
 void GPIOController::setAllPinsLow() {
     if (!initialized) {
         return;
     }
     
-    for (int i = 0; i < 64; ++i) {
-        if (isValidPin(i)) {
-            setPin(i, false);
-        }
-    }
+    backend->write(0, outputPins);
+    pinStates &= ~outputPins;
 }
 
 void GPIOController::setAllPinsHigh() {
@@ -171,11 +207,8 @@ void GPIOController::setAllPinsHigh() {
         return;
     }
     
-    for (int i = 0; i < 64; ++i) {
-        if (isValidPin(i)) {
-            setPin(i, true);
-        }
-    }
+    backend->write(outputPins, 0);
+    pinStates |= outputPins;
 }
 
 bool GPIOController::isValidPin(int pin) const {
@@ -186,16 +219,25 @@ void GPIOController::initializePins() {
     // Initialize all pins to output mode
     for (int pin : {GPIOPins::DATA_PIN, GPIOPins::CLOCK_PIN, GPIOPins::LATCH_PIN,
                      GPIOPins::OE_PIN, GPIOPins::ADDR_A, GPIOPins::ADDR_B,
-                     GPIOPins::ADDR_C, GPIOPins::ADDR_D, GPIOPins::RESET_PIN,
-                     GPIOPins::BLANK_PIN}) {
+                     GPIOPins::ADDR_C, GPIOPins::ADDR_D, GPIOPins::ADDR_E,
+                     GPIOPins::R1_PIN, GPIOPins::G1_PIN, GPIOPins::B1_PIN,
+                     GPIOPins::R2_PIN, GPIOPins::G2_PIN, GPIOPins::B2_PIN,
+                     GPIOPins::RESET_PIN, GPIOPins::BLANK_PIN}) {
         setPinMode(pin, 1); // OUTPUT mode
         setPin(pin, false);  // Start low
     }
+    
+    // Keep the panels blank until the first frame is latched
+    enableOutput(false);
 }
 
 void GPIOController::cleanupPins() {
-    // Set all pins to safe state
-    setAllPinsLow();
+    // Blank the panels first (OE is active low), then drive the rest of our
+    // pins low; pins this program never configured are left alone
+    enableOutput(false);
+    uint64_t oeBit = uint64_t(1) << GPIOPins::OE_PIN;
+    backend->write(0, outputPins & ~oeBit);
+    pinStates &= ~(outputPins & ~oeBit);
 }
 
 } // namespace LEDCube 
\ No newline at end of file
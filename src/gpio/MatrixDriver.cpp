@@ -1,13 +1,20 @@
 #include "gpio/MatrixDriver.h"
+#include "core/FrameProfiler.h"
 #include <iostream>
 #include <thread>
 #include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
 
 namespace LEDCube {
 
-MatrixDriver::MatrixDriver() 
-    : initialized(false), refreshRate(60), brightness(1.0), currentLayer(0),
-      displayThreadRunning(false), shouldStop(false) {
+MatrixDriver::MatrixDriver(std::unique_ptr<GPIOBackend> gpioBackend)
+    : gpioBackend(std::move(gpioBackend)), encodedSequence(0), encodeCount(0), rowPairVersions{},
+      fullEncodeRequested(true), displayThreadRunning(false), shouldStop(false), refreshRate(60),
+      bitDepth(BitplaneEncoder::MAX_BIT_DEPTH), planeBaseTimeNs(130), currentLayer(0), initialized(false) {
+    resetEncodedFrames();
 }
 
 MatrixDriver::~MatrixDriver() {
@@ -47,12 +54,34 @@ void MatrixDriver::shutdown() {
     std::cout << "Matrix Driver: Shutdown complete" << std::endl;
 }
 
+MatrixBuffer& MatrixDriver::acquireBackBuffer() {
+    return backBuffer;
+}
+
+void MatrixDriver::presentBackBuffer() {
+    encodeFrame(backBuffer, encodedSequence + 1);
+    backBuffer.resetDirty();
+}
+
 void MatrixDriver::setBuffer(const MatrixBuffer& buffer) {
-    displayBuffer = buffer;
+    backBuffer.copyFrom(buffer);
+    backBuffer.markAllDirty();
+    presentBackBuffer();
 }
 
 void MatrixDriver::updateBuffer(const MatrixBuffer& buffer) {
-    displayBuffer = buffer;
+    setBuffer(buffer);
+}
+
+bool MatrixDriver::setBufferLayout(BufferLayout layout) {
+    if (displayThreadRunning) {
+        std::cerr << "Matrix Driver: Stop the display before changing the buffer layout" << std::endl;
+        return false;
+    }
+    
+    backBuffer.setLayout(layout);
+    fullEncodeRequested = true;
+    return true;
 }
 
 void MatrixDriver::startDisplay() {
@@ -62,6 +91,7 @@ void MatrixDriver::startDisplay() {
     
     std::cout << "Matrix Driver: Starting display thread..." << std::endl;
     
+    governor.setOptions(governorOptions);
     shouldStop = false;
     displayThreadRunning = true;
     displayThread = std::thread(&MatrixDriver::displayLoop, this);
@@ -87,10 +117,96 @@ void MatrixDriver::setRefreshRate(int fps) {
 }
 
 void MatrixDriver::setBrightness(double level) {
-    brightness = std::max(0.0, std::min(1.0, level));
+    double brightness = std::max(0.0, std::min(1.0, level));
+    {
+        std::lock_guard<std::mutex> lock(colorMutex);
+        colorSettings.brightness = brightness;
+    }
+    fullEncodeRequested = true;
     std::cout << "Matrix Driver: Brightness set to " << (brightness * 100) << "%" << std::endl;
 }
 
+double MatrixDriver::getBrightness() const {
+    std::lock_guard<std::mutex> lock(colorMutex);
+    return colorSettings.brightness;
+}
+
+void MatrixDriver::setColorSettings(const ColorSettings& settings) {
+    {
+        std::lock_guard<std::mutex> lock(colorMutex);
+        colorSettings = settings;
+    }
+    fullEncodeRequested = true;
+    std::cout << "Matrix Driver: Color settings updated (gamma " << settings.gamma << ")" << std::endl;
+}
+
+ColorSettings MatrixDriver::getColorSettings() const {
+    std::lock_guard<std::mutex> lock(colorMutex);
+    return colorSettings;
+}
+
+void MatrixDriver::setPowerBudget(const PowerBudget& budget) {
+    {
+        std::lock_guard<std::mutex> lock(colorMutex);
+        powerBudget = budget;
+    }
+    if (budget.maxAmps > 0.0) {
+        std::cout << "Matrix Driver: Power budget set to " << budget.maxAmps << " A" << std::endl;
+    } else {
+        std::cout << "Matrix Driver: Power limiting disabled" << std::endl;
+    }
+}
+
+PowerBudget MatrixDriver::getPowerBudget() const {
+    std::lock_guard<std::mutex> lock(colorMutex);
+    return powerBudget;
+}
+
+PowerStats MatrixDriver::getPowerStats() const {
+    std::lock_guard<std::mutex> lock(powerStatsMutex);
+    return powerStats;
+}
+
+void MatrixDriver::setBitDepth(int bits) {
+    bitDepth = std::max(BitplaneEncoder::MIN_BIT_DEPTH, std::min(BitplaneEncoder::MAX_BIT_DEPTH, bits));
+    fullEncodeRequested = true;
+    std::cout << "Matrix Driver: Bit depth set to " << bitDepth << " bits" << std::endl;
+}
+
+void MatrixDriver::setPlaneBaseTime(unsigned int nanoseconds) {
+    planeBaseTimeNs = std::max(1u, nanoseconds);
+    std::cout << "Matrix Driver: Bit plane base time set to " << planeBaseTimeNs << " ns" << std::endl;
+}
+
+bool MatrixDriver::setPixelMapper(const PixelMapper& mapper) {
+    if (displayThreadRunning) {
+        std::cerr << "Matrix Driver: Stop the display before changing the pixel mapping" << std::endl;
+        return false;
+    }
+    
+    const ChainLayout& layout = mapper.getLayout();
+    if (!configureChainPins(layout)) {
+        return false;
+    }
+    encoder.setMapper(mapper);
+    resetEncodedFrames();
+    
+    std::cout << "Matrix Driver: " << layout.chainCount << " chain(s) of up to "
+              << layout.getPanelsPerChain() << " panels" << std::endl;
+    return true;
+}
+
+bool MatrixDriver::setChainLayout(const ChainLayout& layout) {
+    PixelMapper mapper = encoder.getMapper();
+    try {
+        mapper.setLayout(layout);
+    } catch (const std::invalid_argument& e) {
+        std::cerr << "Matrix Driver: Invalid chain layout: " << e.what() << std::endl;
+        return false;
+    }
+    return setPixelMapper(mapper);
+}
+
 void MatrixDriver::setCurrentLayer(int layer) {
     if (layer >= 0 && layer < CUBE_DEPTH) {
         currentLayer = layer;
@@ -98,7 +214,9 @@ void MatrixDriver::setCurrentLayer(int layer) {
 }
 
 void MatrixDriver::clearDisplay() {
-    displayBuffer.clear();
+    backBuffer.clear();
+    backBuffer.markAllDirty();
+    presentBackBuffer();
 }
 
 void MatrixDriver::testPattern() {
@@ -116,56 +234,150 @@ void MatrixDriver::testPattern() {
                 } else {
                     color = Color::Blue();
                 }
-                displayBuffer.setLED(Position(x, y, z), color);
+                backBuffer.setLED(Position(x, y, z), color);
             }
         }
     }
+    backBuffer.markAllDirty();
+    presentBackBuffer();
 }
 
 void MatrixDriver::setAllLEDs(const Color& color) {
-    displayBuffer.fill(color);
+    backBuffer.fill(color);
+    backBuffer.markAllDirty();
+    presentBackBuffer();
 }
 
 void MatrixDriver::displayLoop() {
     std::cout << "Matrix Driver: Display loop started" << std::endl;
+    FrameProfiler::setThreadName("display");
+    Realtime::apply(displayOptions);
+    
+    if (governor.isEnabled()) {
+        calibrateScan();
+    }
     
-    auto frameTime = std::chrono::microseconds(1000000 / refreshRate);
+    // Every scan and row has an absolute deadline, so a late wake-up
+    // delays only that row instead of shifting all later ones
+    auto frameStart = std::chrono::steady_clock::now();
+    auto lastTune = frameStart;
     
     while (!shouldStop) {
-        auto startTime = std::chrono::high_resolution_clock::now();
+        auto framePeriod = std::chrono::nanoseconds(1000000000 / std::max(1, refreshRate.load()));
         
-        // Render current frame
-        renderFrame();
+        // Latch the newest encoded frame, if the producer presented one;
+        // otherwise the last one is scanned again
+        frames.latch();
+        renderPacedFrame(frameStart, framePeriod / BitplaneEncoder::ROW_PAIRS);
         
-        // Calculate sleep time to maintain frame rate
-        auto endTime = std::chrono::high_resolution_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
-        auto sleepTime = frameTime - elapsed;
+        // After an overrun of a whole scan, restart the schedule from now
+        // rather than rushing through the missed scans
+        frameStart += framePeriod;
+        auto now = std::chrono::steady_clock::now();
+        if (now - frameStart >= framePeriod) {
+            frameStart = now;
+        }
         
-        if (sleepTime.count() > 0) {
-            std::this_thread::sleep_for(sleepTime);
+        // Re-tune to the throughput measured since the last interval
+        if (governor.isEnabled() && now - lastTune >= governor.getOptions().interval) {
+            applyOperatingPoint(governor.update(frames.front().bitDepth, planeBaseTimeNs));
+            lastTune = now;
         }
     }
     
     std::cout << "Matrix Driver: Display loop stopped" << std::endl;
 }
 
-void MatrixDriver::renderLayer(int layer) {
+void MatrixDriver::renderPacedFrame(std::chrono::steady_clock::time_point start, std::chrono::nanoseconds rowPeriod) {
     if (!initialized) {
         return;
     }
     
-    // Set the current layer
-    setCurrentLayer(layer);
+    const EncodedFrame& frame = frames.front();
+    for (int rowPair = 0; rowPair < BitplaneEncoder::ROW_PAIRS; ++rowPair) {
+        auto deadline = start + rowPeriod * rowPair;
+        {
+            ScopedStageTimer timer(FrameStage::Sleep);
+            Realtime::waitUntil(deadline);
+        }
+        rowJitter.record(deadline, std::chrono::steady_clock::now(), rowPeriod);
+        
+        ScopedStageTimer timer(FrameStage::ScanOut);
+        if (governor.isEnabled()) {
+            auto rowStart = std::chrono::steady_clock::now();
+            renderRowPair(frame, rowPair);
+            governor.recordRowPair(std::chrono::steady_clock::now() - rowStart, frame.bitDepth, planeBaseTimeNs);
+        } else {
+            renderRowPair(frame, rowPair);
+        }
+    }
+}
+
+void MatrixDriver::calibrateScan() {
+    // One unpaced refresh of whatever is encoded measures the shift cost
+    // on this host before the first paced scan
+    frames.latch();
+    const EncodedFrame& frame = frames.front();
+    for (int rowPair = 0; rowPair < BitplaneEncoder::ROW_PAIRS; ++rowPair) {
+        auto rowStart = std::chrono::steady_clock::now();
+        renderRowPair(frame, rowPair);
+        governor.recordRowPair(std::chrono::steady_clock::now() - rowStart, frame.bitDepth, planeBaseTimeNs);
+    }
+    applyOperatingPoint(governor.update(frame.bitDepth, planeBaseTimeNs));
+}
+
+void MatrixDriver::applyOperatingPoint(const ScanOperatingPoint& point) {
+    bool depthChanged = point.bitDepth != bitDepth;
+    if (depthChanged) {
+        bitDepth = point.bitDepth;
+        fullEncodeRequested = true;
+    }
+    refreshRate = point.refreshRate;
+    
+    {
+        std::lock_guard<std::mutex> lock(operatingPointMutex);
+        operatingPoint = point;
+    }
     
-    // In real implementation, this would:
-    // 1. Set address pins for layer selection
-    // 2. Send RGB data for this layer
-    // 3. Latch the data
-    // 4. Enable output for this layer
+    if (depthChanged) {
+        std::cout << "Matrix Driver: Scan governor chose " << point.bitDepth << " bits at "
+                  << point.refreshRate << " Hz (capacity " << static_cast<int>(point.capacity) << " Hz"
+                  << (point.meetsMinimum ? "" : ", below the minimum refresh rate") << ")" << std::endl;
+    }
+}
+
+ScanOperatingPoint MatrixDriver::getOperatingPoint() const {
+    std::lock_guard<std::mutex> lock(operatingPointMutex);
+    return operatingPoint;
+}
+
+void MatrixDriver::renderRowPair(const EncodedFrame& frame, int rowPair) {
+    unsigned int baseTime = planeBaseTimeNs;
     
-    // For simulation, we'll just simulate the timing
-    std::this_thread::sleep_for(std::chrono::microseconds(100));
+    for (int plane = 0; plane < frame.bitDepth; ++plane) {
+        // Shift one precomputed word per column, feeding every chain at
+        // once, with the display blanked
+        const uint32_t* words = frame.getRowPlane(rowPair, plane);
+        for (int column = 0; column < frame.chainLength; ++column) {
+            gpio->writeBits(words[column], frame.dataMask);
+            gpio->setPin(GPIOPins::CLOCK_PIN, true);
+            gpio->setPin(GPIOPins::CLOCK_PIN, false);
+        }
+        
+        // Select the row pair, latch, and light it for the plane's weight;
+        // under the power limit for only part of it, blanked for the rest
+        // so the row timing stays the same
+        unsigned int planeTime = baseTime << plane;
+        unsigned int litTime = static_cast<unsigned int>((static_cast<uint64_t>(planeTime) * frame.outputScale) >> 16);
+        gpio->writeBits(BitplaneEncoder::rowAddressBits(rowPair), BitplaneEncoder::ADDRESS_MASK);
+        gpio->latchData();
+        gpio->enableOutput(true);
+        gpio->delayNanoseconds(litTime);
+        gpio->enableOutput(false);
+        if (litTime < planeTime) {
+            gpio->delayNanoseconds(planeTime - litTime);
+        }
+    }
 }
 
 void MatrixDriver::renderFrame() {
@@ -173,17 +385,137 @@ void MatrixDriver::renderFrame() {
         return;
     }
     
-    // Render each layer in sequence
-    for (int layer = 0; layer < CUBE_DEPTH; ++layer) {
-        renderLayer(layer);
+    // One refresh: every row pair through every bit plane
+    frames.latch();
+    for (int rowPair = 0; rowPair < BitplaneEncoder::ROW_PAIRS; ++rowPair) {
+        renderRowPair(frames.front(), rowPair);
     }
 }
 
+void MatrixDriver::encodeFrame(const MatrixBuffer& buffer, uint64_t sequence) {
+    ScopedStageTimer timer(FrameStage::Convert);
+    
+    // Dirty rows are relative to the previous frame, so any skipped frame
+    // (or a settings change) forces a full re-encode
+    bool full = fullEncodeRequested.exchange(false) || sequence != encodedSequence + 1;
+    
+    // Settings are applied here, on the producer thread that owns the
+    // encoder, so the display thread never waits on colorMutex
+    ColorSettings settings;
+    PowerBudget budget;
+    {
+        std::lock_guard<std::mutex> lock(colorMutex);
+        settings = colorSettings;
+        budget = powerBudget;
+    }
+    if (full && encoder.getBitDepth() != bitDepth) {
+        encoder.setBitDepth(bitDepth);
+    }
+    
+    // The power limiter may lower the brightness for this frame's content.
+    // It is applied at scan-out as a shorter lit time per plane, which cuts
+    // the draw in proportion, so the encoded rows stay valid as it moves.
+    limiter.setBudget(budget);
+    limiter.setColorSettings(settings);
+    limiter.update(buffer, full);
+    double limited = limiter.limit(settings.brightness);
+    double scale = settings.brightness > 0.0 ? limited / settings.brightness : 1.0;
+    unsigned int outputScale = static_cast<unsigned int>(std::lround(scale * (1u << 16)));
+    
+    // Rebuilds the color tables only if the settings changed, which then
+    // invalidates every row
+    if (settings != encoder.getColorSettings()) {
+        encoder.setColorSettings(settings);
+        full = true;
+    }
+    
+    uint32_t changed = encoder.encode(buffer, full);
+    encodedSequence = sequence;
+    ++encodeCount;
+    for (int rowPair = 0; rowPair < BitplaneEncoder::ROW_PAIRS; ++rowPair) {
+        if (changed & (1u << rowPair)) {
+            rowPairVersions[rowPair] = encodeCount;
+        }
+    }
+    
+    // The back slot last held a frame one or more presents ago, so it
+    // takes every row pair changed since then, or all of them after a
+    // change of bit depth or chain layout
+    EncodedFrame& frame = frames.acquireBack();
+    if (frame.bitDepth != encoder.getBitDepth() || frame.chainLength != encoder.getChainLength()) {
+        frame.planes.assign(encoder.getPlaneBytes() / sizeof(uint32_t), 0);
+        frame.bitDepth = encoder.getBitDepth();
+        frame.chainLength = encoder.getChainLength();
+        frame.version = 0;
+    }
+    frame.dataMask = encoder.getDataMask();
+    size_t rowBytes = static_cast<size_t>(frame.chainLength) * sizeof(uint32_t);
+    for (int rowPair = 0; rowPair < BitplaneEncoder::ROW_PAIRS; ++rowPair) {
+        if (rowPairVersions[rowPair] <= frame.version) {
+            continue;
+        }
+        for (int plane = 0; plane < frame.bitDepth; ++plane) {
+            std::memcpy(frame.getRowPlane(rowPair, plane), encoder.getRowPlane(rowPair, plane), rowBytes);
+        }
+    }
+    frame.outputScale = outputScale;
+    frame.version = encodeCount;
+    frames.publish();
+    
+    if (limiter.isEnabled()) {
+        std::lock_guard<std::mutex> lock(powerStatsMutex);
+        powerStats = limiter.getStats();
+    }
+}
+
+void MatrixDriver::resetEncodedFrames() {
+    // Blank planes in the encoder's geometry until the next frame is
+    // presented; only while the display is stopped
+    for (int i = 0; i < frames.slotCount(); ++i) {
+        EncodedFrame& frame = frames.slot(i);
+        frame.planes.assign(encoder.getPlaneBytes() / sizeof(uint32_t), 0);
+        frame.bitDepth = encoder.getBitDepth();
+        frame.chainLength = encoder.getChainLength();
+        frame.dataMask = encoder.getDataMask();
+        frame.version = 0;
+    }
+    fullEncodeRequested = true;
+}
+
 void MatrixDriver::initializeGPIO() {
-    gpio = std::make_unique<GPIOController>();
+    gpio = std::make_unique<GPIOController>(std::move(gpioBackend));
     if (!gpio->initialize()) {
         throw std::runtime_error("Failed to initialize GPIO controller");
     }
+    if (!configureChainPins(encoder.getLayout())) {
+        throw std::runtime_error("Chain pins unavailable");
+    }
+}
+
+bool MatrixDriver::configureChainPins(const ChainLayout& layout) {
+    // GPIOController sets up the first chain; the others only when used
+    if (!gpio || !gpio->isInitialized()) {
+        return true;
+    }
+    
+    uint64_t mask = 0;
+    for (int chain = 1; chain < layout.chainCount; ++chain) {
+        mask |= ChainLayout::PINS[chain].mask();
+    }
+    if (!gpio->setChainPins(mask)) {
+        std::cerr << "Matrix Driver: " << layout.chainCount << " chains need GPIO " << GPIOPins::DATA_PIN
+                  << ", which the SPI data path is using" << std::endl;
+        return false;
+    }
+    
+    for (int chain = 1; chain < layout.chainCount; ++chain) {
+        const ChainPins& pins = ChainLayout::PINS[chain];
+        for (int pin : {pins.r1, pins.g1, pins.b1, pins.r2, pins.g2, pins.b2}) {
+            gpio->setPinMode(pin, 1);
+            gpio->setPin(pin, false);
+        }
+    }
+    return true;
 }
 
 void MatrixDriver::cleanupGPIO() {
@@ -198,27 +530,4 @@ void MatrixDriver::setupTiming() {
     // In real implementation, this would configure SPI timing, etc.
 }
 
-uint16_t MatrixDriver::colorToHardwareFormat(const Color& color) const {
-    // Convert color to hardware format (e.g., RGB565)
-    uint8_t r = static_cast<uint8_t>(color.r * brightness);
-    uint8_t g = static_cast<uint8_t>(color.g * brightness);
-    uint8_t b = static_cast<uint8_t>(color.b * brightness);
-    
-    // Convert to RGB565
-    uint16_t r5 = (r * 31) / 255;
-    uint16_t g6 = (g * 63) / 255;
-    uint16_t b5 = (b * 31) / 255;
-    
-    return (r5 << 11) | (g6 << 5) | b5;
-}
-
-Color MatrixDriver::hardwareFormatToColor(uint16_t hwColor) const {
-    // Convert hardware format back to Color
-    uint8_t r = ((hwColor >> 11) & 0x1F) * 255 / 31;
-    uint8_t g = ((hwColor >> 5) & 0x3F) * 255 / 63;
-    uint8_t b = (hwColor & 0x1F) * 255 / 31;
-    
-    return Color(r, g, b);
-}
-
 } // namespace LEDCube 
\ No newline at end of file
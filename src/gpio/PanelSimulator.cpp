@@ -0,0 +1,208 @@
+#include "gpio/PanelSimulator.h"
+#include "gpio/GPIOController.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace LEDCube {
+
+namespace {
+
+constexpr uint64_t bit(int pin) {
+    return uint64_t(1) << pin;
+}
+
+constexpr uint64_t ADDRESS_PINS = bit(GPIOPins::ADDR_A) | bit(GPIOPins::ADDR_B) | bit(GPIOPins::ADDR_C) |
+                                  bit(GPIOPins::ADDR_D) | bit(GPIOPins::ADDR_E);
+
+const ChainLayout& validated(const ChainLayout& layout) {
+    layout.validate();
+    return layout;
+}
+
+} // namespace
+
+PanelSimulator::PanelSimulator(uint64_t writeTimeNs, const ChainLayout& layout)
+    : layout(validated(layout)), chainLength(layout.getChainLength()), dataMask(layout.getDataMask()),
+      writeTimeNs(writeTimeNs), now(0), pins(0),
+      shiftRegister(chainLength, 0), shiftHead(0), outputLatch(chainLength, 0),
+      litSince(0), outputOnSince(0), lastLitRowPair(-1),
+      channelOnTime(TOTAL_LEDS * 3, 0), rowPairOnTime(ROW_PAIRS, 0) {
+    int panelsPerChain = layout.getPanelsPerChain();
+    slotFaces.assign(static_cast<size_t>(layout.chainCount) * panelsPerChain, -1);
+    for (int face = 0; face < CUBE_DEPTH; ++face) {
+        slotFaces[layout.faces[face].position * layout.chainCount + layout.faces[face].chain] = face;
+    }
+    resetStatistics();
+}
+
+void PanelSimulator::write(uint64_t setMask, uint64_t clearMask) {
+    uint64_t next = (pins | setMask) & ~clearMask;
+    uint64_t rising = next & ~pins;
+    uint64_t changed = next ^ pins;
+    bool wasEnabled = outputEnabled();
+
+    // The old pin state holds until this write completes
+    now += writeTimeNs;
+    ++pinWrites;
+
+    if ((changed & (bit(GPIOPins::OE_PIN) | ADDRESS_PINS)) || (rising & bit(GPIOPins::LATCH_PIN))) {
+        accumulateLight();
+    }
+
+    if (rising & bit(GPIOPins::CLOCK_PIN)) {
+        shiftHead = (shiftHead + chainLength - 1) % chainLength;
+        shiftRegister[shiftHead] = static_cast<uint32_t>(next) & dataMask;
+    }
+
+    if (rising & bit(GPIOPins::LATCH_PIN)) {
+        std::rotate_copy(shiftRegister.begin(), shiftRegister.begin() + shiftHead, shiftRegister.end(),
+                         outputLatch.begin());
+    }
+
+    pins = next;
+
+    // OE edges: pulse widths and refresh passes
+    bool enabled = outputEnabled();
+    if (enabled && !wasEnabled) {
+        outputOnSince = now;
+        int rowPair = selectedRowPair();
+        if (rowPair == ROW_PAIRS - 1 && lastLitRowPair != ROW_PAIRS - 1) {
+            ++refreshes;
+        }
+        lastLitRowPair = rowPair;
+    } else if (!enabled && wasEnabled) {
+        uint64_t pulse = now - outputOnSince;
+        shortestPulse = std::min(shortestPulse, pulse);
+        longestPulse = std::max(longestPulse, pulse);
+    }
+}
+
+void PanelSimulator::delayNanoseconds(uint64_t nanoseconds) {
+    // Nothing changes, so light is integrated at the next pin write
+    now += nanoseconds;
+}
+
+void PanelSimulator::resetStatistics() {
+    std::fill(channelOnTime.begin(), channelOnTime.end(), 0);
+    std::fill(rowPairOnTime.begin(), rowPairOnTime.end(), 0);
+    statisticsStart = now;
+    litSince = now;
+    outputOnSince = now;
+    lastLitRowPair = -1;
+    pinWrites = 0;
+    refreshes = 0;
+    shortestPulse = std::numeric_limits<uint64_t>::max();
+    longestPulse = 0;
+}
+
+PanelStatistics PanelSimulator::getStatistics() const {
+    // Light is integrated when pins change, so a still-open OE period is
+    // not included until it ends
+    PanelStatistics statistics;
+    uint64_t elapsed = now - statisticsStart;
+    uint64_t litTime = 0;
+    for (uint64_t time : rowPairOnTime) {
+        litTime += time;
+    }
+
+    statistics.elapsedSeconds = elapsed / 1e9;
+    statistics.pinWrites = pinWrites;
+    statistics.refreshes = refreshes;
+    if (elapsed > 0) {
+        statistics.refreshRate = refreshes / statistics.elapsedSeconds;
+        statistics.outputDuty = static_cast<double>(litTime) / elapsed;
+    }
+    if (longestPulse > 0) {
+        statistics.shortestPulseNs = static_cast<double>(shortestPulse);
+        statistics.longestPulseNs = static_cast<double>(longestPulse);
+    }
+    if (refreshes > 0 && longestPulse > 0) {
+        double litPerRowPair = static_cast<double>(litTime) / (refreshes * ROW_PAIRS);
+        statistics.effectiveBitDepth = std::log2(litPerRowPair / shortestPulse + 1.0);
+    }
+    return statistics;
+}
+
+double PanelSimulator::getDutyCycle(int face, int x, int y, int channel) const {
+    uint64_t elapsed = now - statisticsStart;
+    if (elapsed == 0) {
+        return 0.0;
+    }
+    int index = face * (CUBE_SIZE * CUBE_SIZE) + y * CUBE_SIZE + x;
+    return static_cast<double>(channelOnTime[index * 3 + channel]) / elapsed;
+}
+
+std::vector<Color> PanelSimulator::getImage() const {
+    std::vector<Color> image(TOTAL_LEDS, Color::Black());
+    for (int index = 0; index < TOTAL_LEDS; ++index) {
+        int y = (index / CUBE_SIZE) % CUBE_SIZE;
+        uint64_t rowPairTime = rowPairOnTime[y % ROW_PAIRS];
+        if (rowPairTime == 0) {
+            continue;
+        }
+
+        auto level = [&](int channel) {
+            double fraction = static_cast<double>(channelOnTime[index * 3 + channel]) / rowPairTime;
+            return static_cast<uint8_t>(std::lround(std::min(1.0, fraction) * 255.0));
+        };
+        image[index] = Color(level(0), level(1), level(2));
+    }
+    return image;
+}
+
+bool PanelSimulator::outputEnabled() const {
+    return (pins & bit(GPIOPins::OE_PIN)) == 0; // Active low
+}
+
+int PanelSimulator::selectedRowPair() const {
+    return static_cast<int>(((pins >> GPIOPins::ADDR_A) & 1) |
+                            (((pins >> GPIOPins::ADDR_B) & 1) << 1) |
+                            (((pins >> GPIOPins::ADDR_C) & 1) << 2) |
+                            (((pins >> GPIOPins::ADDR_D) & 1) << 3) |
+                            (((pins >> GPIOPins::ADDR_E) & 1) << 4));
+}
+
+void PanelSimulator::accumulateLight() {
+    uint64_t duration = now - litSince;
+    litSince = now;
+    if (!outputEnabled() || duration == 0) {
+        return;
+    }
+
+    // The latched columns light rows rowPair (R1/G1/B1) and rowPair + 32
+    // (R2/G2/B2) of every panel
+    int rowPair = selectedRowPair();
+    rowPairOnTime[rowPair] += duration;
+    for (int position = 0; position < chainLength; ++position) {
+        uint32_t word = outputLatch[position];
+        if (word == 0) {
+            continue;
+        }
+
+        int x = CUBE_SIZE - 1 - position % CUBE_SIZE;
+        const int* faces = &slotFaces[(position / CUBE_SIZE) * layout.chainCount];
+        for (int chain = 0; chain < layout.chainCount; ++chain) {
+            const ChainPins& chainPins = ChainLayout::PINS[chain];
+            int face = faces[chain];
+            if (face < 0 || (word & chainPins.mask()) == 0) {
+                continue;
+            }
+
+            uint64_t* upper = &channelOnTime[(face * (CUBE_SIZE * CUBE_SIZE) + rowPair * CUBE_SIZE + x) * 3];
+            uint64_t* lower = upper + ROW_PAIRS * CUBE_SIZE * 3;
+            const int upperPins[3] = {chainPins.r1, chainPins.g1, chainPins.b1};
+            const int lowerPins[3] = {chainPins.r2, chainPins.g2, chainPins.b2};
+            for (int channel = 0; channel < 3; ++channel) {
+                if (word & (1u << upperPins[channel])) {
+                    upper[channel] += duration;
+                }
+                if (word & (1u << lowerPins[channel])) {
+                    lower[channel] += duration;
+                }
+            }
+        }
+    }
+}
+
+} // namespace LEDCube
@@ -0,0 +1,189 @@
+#include "gpio/PixelMapper.h"
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace LEDCube {
+
+PixelMapper::PixelMapper() : PixelMapper(ChainLayout()) {
+}
+
+PixelMapper::PixelMapper(const ChainLayout& layout) : lut(2 * TOTAL_LEDS) {
+    setLayout(layout);
+    for (int face = 0; face < CUBE_DEPTH; ++face) {
+        compile(face);
+    }
+}
+
+void PixelMapper::setLayout(const ChainLayout& newLayout) {
+    // Slots only decide where a face's words go, so the LUT is unaffected
+    newLayout.validate();
+    layout = newLayout;
+}
+
+void PixelMapper::setOrientation(int face, const FaceOrientation& orientation) {
+    if (face < 0 || face >= CUBE_DEPTH) {
+        throw std::invalid_argument("Face " + std::to_string(face) + " does not exist");
+    }
+    if (orientation.rotation % 90 != 0 || orientation.rotation < 0 || orientation.rotation >= 360) {
+        throw std::invalid_argument("Rotation must be 0, 90, 180 or 270, got " + std::to_string(orientation.rotation));
+    }
+    orientations[face] = orientation;
+    compile(face);
+}
+
+void PixelMapper::panelToFace(int face, int panelX, int panelY, int& x, int& y) const {
+    const FaceOrientation& orientation = orientations[face];
+    const int last = CUBE_SIZE - 1;
+
+    // Undo the mirroring, then the clockwise rotation
+    int u = orientation.mirrorX ? last - panelX : panelX;
+    int v = orientation.mirrorY ? last - panelY : panelY;
+    switch (orientation.rotation) {
+        case 90:  x = v;        y = last - u; break;
+        case 180: x = last - u; y = last - v; break;
+        case 270: x = last - v; y = u;        break;
+        default:  x = u;        y = v;        break;
+    }
+}
+
+void PixelMapper::compile(int face) {
+    uint16_t* faceMajor = lut.data() + face * (CUBE_SIZE * CUBE_SIZE);
+    uint16_t* scanOrder = faceMajor + TOTAL_LEDS;
+    panelRows[face].fill(0);
+    for (int panelY = 0; panelY < CUBE_SIZE; ++panelY) {
+        for (int panelX = 0; panelX < CUBE_SIZE; ++panelX) {
+            int x, y;
+            panelToFace(face, panelX, panelY, x, y);
+            int entry = panelY * CUBE_SIZE + panelX;
+            faceMajor[entry] = static_cast<uint16_t>(MatrixBuffer::layoutIndex(BufferLayout::FaceMajor, x, y, face));
+            scanOrder[entry] = static_cast<uint16_t>(MatrixBuffer::layoutIndex(BufferLayout::ScanOrder, x, y, face));
+            panelRows[face][y] |= uint64_t(1) << panelY;
+        }
+    }
+}
+
+bool PixelMapper::isScanNative() const {
+    if (layout.chainCount != 1) {
+        return false;
+    }
+    for (int face = 0; face < CUBE_DEPTH; ++face) {
+        const FaceOrientation& orientation = orientations[face];
+        if (layout.faces[face].position != face || orientation.rotation != 0 ||
+            orientation.mirrorX || orientation.mirrorY) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint64_t PixelMapper::getPanelRows(int face, uint64_t bufferRows) const {
+    uint64_t rows = 0;
+    while (bufferRows != 0) {
+        int y = __builtin_ctzll(bufferRows);
+        bufferRows &= bufferRows - 1;
+        rows |= panelRows[face][y];
+    }
+    return rows;
+}
+
+PixelMapper PixelMapper::parse(std::istream& input, const std::string& sourceName) {
+    PixelMapper mapper;
+    ChainLayout layout;
+    std::string line;
+    int lineNumber = 0;
+    bool sawFace = false;
+
+    auto fail = [&](const std::string& message) {
+        throw std::runtime_error(sourceName + ":" + std::to_string(lineNumber) + ": " + message);
+    };
+    auto number = [&](const std::string& key, const std::string& value) {
+        size_t length = 0;
+        int result = 0;
+        try {
+            result = std::stoi(value, &length);
+        } catch (const std::exception&) {
+        }
+        if (length == 0 || length != value.size()) {
+            fail("expected a number for '" + key + "', got '" + value + "'");
+        }
+        return result;
+    };
+
+    while (std::getline(input, line)) {
+        ++lineNumber;
+        std::istringstream words(line.substr(0, line.find('#')));
+        std::string keyword;
+        if (!(words >> keyword)) {
+            continue;
+        }
+
+        try {
+            if (keyword == "chains") {
+                // Resets every face to the interleaved layout, so it has to
+                // come before any face line that would be overwritten
+                if (sawFace) {
+                    fail("'chains' must come before any 'face' line");
+                }
+                std::string value, extra;
+                if (!(words >> value)) {
+                    fail("expected a chain count");
+                }
+                if (words >> extra) {
+                    fail("unexpected '" + extra + "' after the chain count");
+                }
+                layout = ChainLayout::interleaved(number(keyword, value));
+            } else if (keyword == "face") {
+                sawFace = true;
+                int face = -1;
+                if (!(words >> face) || face < 0 || face >= CUBE_DEPTH) {
+                    fail("expected a face number from 0 to " + std::to_string(CUBE_DEPTH - 1));
+                }
+                FaceOrientation orientation = mapper.getOrientation(face);
+                std::string key, value;
+                while (words >> key) {
+                    if (!(words >> value)) {
+                        fail("missing value for '" + key + "'");
+                    }
+                    if (key == "chain") {
+                        layout.faces[face].chain = number(key, value);
+                    } else if (key == "position") {
+                        layout.faces[face].position = number(key, value);
+                    } else if (key == "rotate") {
+                        orientation.rotation = number(key, value);
+                    } else if (key == "mirror") {
+                        if (value.find_first_not_of("xy") != std::string::npos && value != "none") {
+                            fail("mirror must be x, y, xy or none");
+                        }
+                        orientation.mirrorX = value.find('x') != std::string::npos;
+                        orientation.mirrorY = value.find('y') != std::string::npos;
+                    } else {
+                        fail("unknown setting '" + key + "'");
+                    }
+                }
+                mapper.setOrientation(face, orientation);
+            } else {
+                fail("unknown keyword '" + keyword + "'");
+            }
+        } catch (const std::invalid_argument& e) {
+            fail(e.what());
+        }
+    }
+
+    try {
+        mapper.setLayout(layout);
+    } catch (const std::invalid_argument& e) {
+        throw std::runtime_error(sourceName + ": " + e.what());
+    }
+    return mapper;
+}
+
+PixelMapper PixelMapper::loadFromFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open pixel mapping file: " + path);
+    }
+    return parse(file, path);
+}
+
+} // namespace LEDCube
@@ -0,0 +1,113 @@
+#include "gpio/PowerLimiter.h"
+#include "gpio/BitplaneEncoder.h"
+#include <algorithm>
+#include <cmath>
+
+namespace LEDCube {
+
+PowerLimiter::PowerLimiter() : rowSums{}, totalLevels(0), sumsValid(false), output(-1.0) {
+    setColorSettings(ColorSettings());
+}
+
+void PowerLimiter::setBudget(const PowerBudget& newBudget) {
+    if (newBudget == budget) {
+        return;
+    }
+    budget = newBudget;
+    sumsValid = false;
+}
+
+void PowerLimiter::setColorSettings(const ColorSettings& settings) {
+    ColorSettings unscaled = settings;
+    unscaled.brightness = 1.0;
+    if (unscaled == levels.getSettings() && levels.getBitDepth() == BitplaneEncoder::MAX_BIT_DEPTH) {
+        return;
+    }
+    levels.update(unscaled, BitplaneEncoder::MAX_BIT_DEPTH);
+    sumsValid = false;
+}
+
+void PowerLimiter::update(const MatrixBuffer& buffer, bool full) {
+    if (!isEnabled()) {
+        sumsValid = false;
+        return;
+    }
+
+    full = full || !sumsValid;
+    if (full) {
+        for (auto& faceRows : rowSums) {
+            faceRows.fill({0, 0, 0});
+        }
+        totalLevels = 0;
+    }
+    for (int face = 0; face < CUBE_DEPTH; ++face) {
+        uint64_t rows = full ? ALL_ROWS_DIRTY : buffer.getDirtyRows(face);
+        while (rows != 0) {
+            int y = __builtin_ctzll(rows);
+            rows &= rows - 1;
+            sumRow(buffer, face, y);
+        }
+    }
+    sumsValid = true;
+}
+
+void PowerLimiter::sumRow(const MatrixBuffer& buffer, int face, int y) {
+    // A face row is contiguous in face-major order and every other pixel
+    // in scan order
+    const Color* pixel = buffer.getBuffer().data() + MatrixBuffer::layoutIndex(buffer.getLayout(), 0, y, face);
+    int stride = buffer.getLayout() == BufferLayout::ScanOrder ? 2 : 1;
+    const uint16_t* red = levels.getTable(face, 0);
+    const uint16_t* green = levels.getTable(face, 1);
+    const uint16_t* blue = levels.getTable(face, 2);
+
+    std::array<uint32_t, 3> sums = {0, 0, 0};
+    for (int x = 0; x < CUBE_SIZE; ++x, pixel += stride) {
+        sums[0] += red[pixel->r];
+        sums[1] += green[pixel->g];
+        sums[2] += blue[pixel->b];
+    }
+
+    std::array<uint32_t, 3>& previous = rowSums[face][y];
+    totalLevels -= static_cast<uint64_t>(previous[0]) + previous[1] + previous[2];
+    totalLevels += static_cast<uint64_t>(sums[0]) + sums[1] + sums[2];
+    previous = sums;
+}
+
+double PowerLimiter::limit(double requestedBrightness) {
+    if (!isEnabled()) {
+        output = requestedBrightness;
+        stats = PowerStats();
+        return requestedBrightness;
+    }
+
+    // Draw at brightness 1.0 above the idle draw, as a fraction of every
+    // panel at full white
+    double maxLevel = static_cast<double>((1 << BitplaneEncoder::MAX_BIT_DEPTH) - 1);
+    double fullWhite = maxLevel * 3.0 * CUBE_SIZE * CUBE_SIZE;
+    double dynamicAmps = totalLevels / fullWhite * budget.panelFullWhiteAmps;
+    double idleAmps = budget.panelIdleAmps * CUBE_DEPTH;
+
+    double target = requestedBrightness;
+    if (dynamicAmps > 0.0) {
+        target = std::min(target, std::max(0.0, (budget.maxAmps - idleAmps) / dynamicAmps));
+    }
+
+    // Cut at once, recover gradually; 1/256 steps rounded down
+    if (output < 0.0 || target <= output) {
+        output = target;
+    } else {
+        output = std::min(target, output + budget.releaseStep);
+    }
+    output = std::floor(output * 256.0) / 256.0;
+    if (target >= requestedBrightness && requestedBrightness - output < 1.0 / 256.0) {
+        output = requestedBrightness;
+    }
+
+    stats.requestedAmps = idleAmps + dynamicAmps * requestedBrightness;
+    stats.outputAmps = idleAmps + dynamicAmps * output;
+    stats.scale = requestedBrightness > 0.0 ? output / requestedBrightness : 1.0;
+    stats.limiting = output < requestedBrightness;
+    return output;
+}
+
+} // namespace LEDCube
@@ -0,0 +1,72 @@
+#include "gpio/ScanGovernor.h"
+#include "gpio/BitplaneEncoder.h"
+#include <algorithm>
+#include <cmath>
+
+namespace LEDCube {
+
+ScanGovernor::ScanGovernor(const ScanGovernorOptions& options) : shiftNs(0.0), planes(0), rowPairs(0) {
+    setOptions(options);
+}
+
+void ScanGovernor::setOptions(const ScanGovernorOptions& newOptions) {
+    options = newOptions;
+    options.minBitDepth = std::max(BitplaneEncoder::MIN_BIT_DEPTH, std::min(BitplaneEncoder::MAX_BIT_DEPTH, options.minBitDepth));
+    options.maxBitDepth = std::max(options.minBitDepth, std::min(BitplaneEncoder::MAX_BIT_DEPTH, options.maxBitDepth));
+    options.minRefreshRate = std::max(1, options.minRefreshRate);
+    options.maxRefreshRate = std::max(options.minRefreshRate, options.maxRefreshRate);
+}
+
+void ScanGovernor::recordRowPair(std::chrono::nanoseconds duration, int bitDepth, unsigned int baseTimeNs) {
+    // Whatever exceeds the planes' hold time went into shifting and latching
+    double hold = static_cast<double>(baseTimeNs) * ((1 << bitDepth) - 1);
+    shiftNs += std::max(0.0, static_cast<double>(duration.count()) - hold);
+    planes += static_cast<uint64_t>(bitDepth);
+    ++rowPairs;
+}
+
+double ScanGovernor::refreshCapacity(int bitDepth, unsigned int baseTimeNs, double shiftNsPerPlane) {
+    double rowPairNs = bitDepth * shiftNsPerPlane + static_cast<double>(baseTimeNs) * ((1 << bitDepth) - 1);
+    return rowPairNs > 0.0 ? 1e9 / (BitplaneEncoder::ROW_PAIRS * rowPairNs) : 0.0;
+}
+
+ScanOperatingPoint ScanGovernor::update(int currentBitDepth, unsigned int baseTimeNs) {
+    if (planes == 0) {
+        return point;
+    }
+
+    double shiftPerPlane = shiftNs / planes;
+    uint64_t samples = rowPairs;
+    shiftNs = 0.0;
+    planes = 0;
+    rowPairs = 0;
+
+    // Deepest setting that still reaches the minimum refresh rate; going
+    // deeper than now needs the extra margin
+    int chosen = options.minBitDepth;
+    for (int bits = options.maxBitDepth; bits >= options.minBitDepth; --bits) {
+        double usable = refreshCapacity(bits, baseTimeNs, shiftPerPlane) * options.headroom;
+        double required = options.minRefreshRate * (bits > currentBitDepth ? options.upgradeMargin : 1.0);
+        if (usable >= required) {
+            chosen = bits;
+            break;
+        }
+    }
+
+    double capacity = refreshCapacity(chosen, baseTimeNs, shiftPerPlane);
+    double usable = capacity * options.headroom;
+
+    ScanOperatingPoint next;
+    next.bitDepth = chosen;
+    next.meetsMinimum = usable >= options.minRefreshRate;
+    next.refreshRate = std::max(1, static_cast<int>(std::min<double>(options.maxRefreshRate, std::floor(usable))));
+    next.capacity = capacity;
+    next.shiftNsPerPlane = shiftPerPlane;
+    next.load = capacity > 0.0 ? next.refreshRate / capacity : 0.0;
+    next.samples = samples;
+    next.retunes = point.retunes + (point.bitDepth != 0 && chosen != point.bitDepth ? 1 : 0);
+    point = next;
+    return point;
+}
+
+} // namespace LEDCube
@@ -0,0 +1,479 @@
+#include "core/LEDCube.h"
+#include "core/AnimationManager.h"
+#include "core/MatrixBuffer.h"
+#include "core/PixelFormat.h"
+#include "core/FrameProfiler.h"
+#include "core/CubeTopology.h"
+#include "core/JobSystem.h"
+#include "gpio/MatrixDriver.h"
+#include "gpio/PanelSimulator.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+#include <utility>
+#include <atomic>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <new>
+
+using namespace LEDCube;
+
+// Allocation counting: every global operator new in the process is tracked
+static std::atomic<uint64_t> allocationCount{0};
+
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+namespace {
+
+// Prevents the compiler from discarding benchmark results
+template <typename T>
+void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct BenchmarkResult {
+    std::string name;
+    uint64_t iterations;
+    double nsPerFrame;
+    double framesPerSecond;
+    double allocationsPerFrame;
+    uint64_t bytesPerFrame;
+};
+
+class BenchmarkRunner {
+public:
+    BenchmarkRunner(double minTime, const std::string& filter) : minTime(minTime), filter(filter) {}
+
+    // bytesTouched is the number of bytes read plus written by one frame
+    bool matches(const std::string& name) const {
+        return filter.empty() || name.find(filter) != std::string::npos;
+    }
+
+    void run(const std::string& name, uint64_t bytesTouched, const std::function<void()>& frame) {
+        if (!matches(name)) {
+            return;
+        }
+
+        // Warm up caches and lazily allocated state
+        for (int i = 0; i < 3; ++i) {
+            frame();
+        }
+
+        // Grow the batch until it runs for at least minTime
+        uint64_t iterations = 1;
+        double elapsed = 0.0;
+        uint64_t allocations = 0;
+        while (true) {
+            uint64_t allocationsBefore = allocationCount.load(std::memory_order_relaxed);
+            auto start = std::chrono::steady_clock::now();
+            for (uint64_t i = 0; i < iterations; ++i) {
+                frame();
+            }
+            elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            allocations = allocationCount.load(std::memory_order_relaxed) - allocationsBefore;
+
+            if (elapsed >= minTime || iterations >= (uint64_t(1) << 40)) {
+                break;
+            }
+            double scale = elapsed > 0.0 ? (minTime * 1.2) / elapsed : 10.0;
+            iterations = static_cast<uint64_t>(iterations * std::min(std::max(scale, 2.0), 100.0));
+        }
+
+        BenchmarkResult result;
+        result.name = name;
+        result.iterations = iterations;
+        result.nsPerFrame = elapsed * 1e9 / iterations;
+        result.framesPerSecond = iterations / elapsed;
+        result.allocationsPerFrame = static_cast<double>(allocations) / iterations;
+        result.bytesPerFrame = bytesTouched;
+        results.push_back(result);
+
+        std::cout << std::left << std::setw(40) << name << std::right
+                  << std::setw(14) << std::fixed << std::setprecision(1) << result.nsPerFrame << " ns"
+                  << std::setw(14) << std::setprecision(1) << result.framesPerSecond << " fps"
+                  << std::setw(10) << std::setprecision(2) << result.allocationsPerFrame << " alloc"
+                  << std::setw(10) << bytesTouched << " B" << std::endl;
+    }
+
+    std::string toJSON() const {
+        std::ostringstream json;
+        json << "{\n";
+        json << "  \"context\": {\n";
+        json << "    \"compiler\": \"" << __VERSION__ << "\",\n";
+#if defined(__aarch64__)
+        json << "    \"arch\": \"aarch64\",\n";
+#elif defined(__arm__)
+        json << "    \"arch\": \"arm\",\n";
+#elif defined(__x86_64__)
+        json << "    \"arch\": \"x86_64\",\n";
+#else
+        json << "    \"arch\": \"unknown\",\n";
+#endif
+        json << "    \"min_time_s\": " << minTime << "\n";
+        json << "  },\n";
+        json << "  \"benchmarks\": [\n";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const auto& r = results[i];
+            json << "    {\"name\": \"" << r.name << "\""
+                 << ", \"iterations\": " << r.iterations
+                 << std::setprecision(3) << std::fixed
+                 << ", \"ns_per_frame\": " << r.nsPerFrame
+                 << ", \"frames_per_second\": " << r.framesPerSecond
+                 << ", \"allocations_per_frame\": " << r.allocationsPerFrame
+                 << ", \"bytes_per_frame\": " << r.bytesPerFrame << "}"
+                 << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        json << "  ]\n";
+        json << "}\n";
+        return json.str();
+    }
+
+private:
+    double minTime;
+    std::string filter;
+    std::vector<BenchmarkResult> results;
+};
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [OPTIONS]" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --filter TEXT     Only run benchmarks whose name contains TEXT" << std::endl;
+    std::cout << "  --min-time SEC    Minimum measured time per benchmark (default: 0.5)" << std::endl;
+    std::cout << "  --json FILE       Write machine-readable results to FILE ('-' = stdout, table to stderr)" << std::endl;
+    std::cout << "  --help, -h        Show this help message" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string filter;
+    std::string jsonPath;
+    double minTime = 0.5;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--filter" && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (arg == "--min-time" && i + 1 < argc) {
+            minTime = std::atof(argv[++i]);
+        } else if (arg == "--json" && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else if (arg == "--help" || arg == "-h") {
+            printUsage(argv[0]);
+            return 0;
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            printUsage(argv[0]);
+            return -1;
+        }
+    }
+
+    // With JSON on stdout, everything else printed (the results table and
+    // library messages, up to the last destructor) goes to stderr
+    std::streambuf* stdoutBuffer = std::cout.rdbuf();
+    if (jsonPath == "-") {
+        std::cout.rdbuf(std::cerr.rdbuf());
+    }
+
+    BenchmarkRunner runner(minTime, filter);
+    const uint64_t frameBytes = TOTAL_LEDS * sizeof(Color);
+    const double deltaTime = 1.0 / 60.0;
+
+    // Animations: update and render measured separately
+    AnimationManager animationManager;
+    LEDCube::LEDCube cube;
+    for (const auto& name : animationManager.getAnimationNames()) {
+        auto animation = animationManager.getAnimation(name);
+        animation->reset();
+        animation->init();
+
+        runner.run(name + "/update", 0, [&]() {
+            animation->update(deltaTime);
+        });
+        runner.run(name + "/render", frameBytes, [&]() {
+            animation->render(cube);
+            cube.resetDirty();
+        });
+    }
+
+    // Game of Life kernel: its update above mostly advances the 0.5 s
+    // generation timer, so time one generation per call here
+    GameOfLifeAnimation life;
+    life.init();
+    life.setUpdateInterval(0.0);
+    const uint64_t gridBytes = 2 * CUBE_DEPTH * CUBE_SIZE * sizeof(uint64_t);
+    runner.run("Game of Life/generation", gridBytes, [&]() {
+        life.update(deltaTime);
+    });
+
+    // Pixel shader scaling: the same frame on one thread and on the shared pool
+    JobSystemOptions singleThreadOptions;
+    singleThreadOptions.workers = 0;
+    JobSystem singleThread(singleThreadOptions);
+    WaveAnimation wave;
+    wave.init();
+    wave.setJobSystem(&singleThread);
+    runner.run("PixelShader/Wave (1 thread)", frameBytes, [&]() {
+        wave.render(cube);
+        cube.resetDirty();
+    });
+    wave.setJobSystem(nullptr);
+    runner.run("PixelShader/Wave (shared jobs, " + std::to_string(JobSystem::shared().getThreadCount()) + " threads)", frameBytes, [&]() {
+        wave.render(cube);
+        cube.resetDirty();
+    });
+    
+    // LEDCube buffer operations
+    runner.run("LEDCube/fill", frameBytes, [&]() {
+        cube.fill(Color::White());
+        cube.resetDirty();
+    });
+    runner.run("LEDCube/fill+clear", 2 * frameBytes, [&]() {
+        cube.fill(Color::White());
+        cube.clear();
+        cube.resetDirty();
+    });
+
+    // MatrixBuffer conversions
+    MatrixBuffer matrixBuffer;
+    matrixBuffer.copyFrom(cube);
+    runner.run("MatrixBuffer/toRGB888", frameBytes + TOTAL_LEDS * 3, [&]() {
+        auto bytes = matrixBuffer.toRGB888();
+        doNotOptimize(bytes.data());
+    });
+    runner.run("MatrixBuffer/toRGB565", frameBytes + TOTAL_LEDS * 2, [&]() {
+        auto bytes = matrixBuffer.toRGB565();
+        doNotOptimize(bytes.data());
+    });
+    MatrixBuffer scanOrderBuffer(BufferLayout::ScanOrder);
+    runner.run("MatrixBuffer/copyFrom (to scan order)", 2 * frameBytes, [&]() {
+        scanOrderBuffer.copyFrom(matrixBuffer);
+        doNotOptimize(scanOrderBuffer.getBuffer().data());
+    });
+
+    // Seam-aware halos for stencil effects
+    const CubeTopology& topology = CubeTopology::instance();
+    std::vector<Color> halos(CubeTopology::HALO_CELLS * CUBE_DEPTH);
+    runner.run("CubeTopology/fillHalos", frameBytes + halos.size() * sizeof(Color), [&]() {
+        topology.fillHalos(matrixBuffer.getBuffer().data(), halos.data());
+        doNotOptimize(halos.data());
+    });
+
+    // Pixel conversion kernels into a caller-owned buffer
+    std::vector<uint8_t> converted(TOTAL_LEDS * 3);
+    const std::pair<const char*, PixelFormat> formats[] = {
+        {"RGB888", PixelFormat::RGB888},
+        {"BGR888", PixelFormat::BGR888},
+        {"RGB565BE", PixelFormat::RGB565BE},
+        {"RGB565LE", PixelFormat::RGB565LE},
+    };
+    std::string defaultKernel = getPixelKernel();
+    for (const auto& kernel : getAvailablePixelKernels()) {
+        setPixelKernel(kernel);
+        for (const auto& format : formats) {
+            uint64_t bytes = frameBytes + TOTAL_LEDS * bytesPerPixel(format.second);
+            for (uint8_t brightness : {uint8_t(255), uint8_t(128)}) {
+                std::string name = "convertPixels/" + kernel + "/" + format.first + (brightness == 255 ? "" : " (scaled)");
+                runner.run(name, bytes, [&]() {
+                    matrixBuffer.convertTo(format.second, converted.data(), converted.size(), brightness);
+                    doNotOptimize(converted.data());
+                });
+            }
+        }
+    }
+    setPixelKernel(defaultKernel);
+
+    // MatrixDriver frame encoding
+    MatrixDriver driver;
+    uint64_t sequence = 0;
+    matrixBuffer.markAllDirty();
+    const uint64_t planeBytes = driver.getEncoder().getPlaneBytes();
+    runner.run("MatrixDriver/encodeFrame (full)", frameBytes + planeBytes, [&]() {
+        sequence += 2; // Skipping a sequence number forces a full encode
+        driver.encodeFrame(matrixBuffer, sequence);
+    });
+    matrixBuffer.resetDirty();
+    for (int face = 0; face < CUBE_DEPTH; ++face) {
+        matrixBuffer.setLED(Position(0, face * 8, face), Color::Red());
+    }
+    runner.run("MatrixDriver/encodeFrame (6 dirty rows)", 6 * (CUBE_SIZE * sizeof(Color) + planeBytes / TOTAL_LEDS * CUBE_SIZE), [&]() {
+        driver.encodeFrame(matrixBuffer, ++sequence);
+    });
+    
+    // Power estimate: incremental after a change of a few rows
+    PowerLimiter limiter;
+    PowerBudget budget;
+    budget.maxAmps = 10.0;
+    limiter.setBudget(budget);
+    runner.run("PowerLimiter/update (full)", frameBytes, [&]() {
+        limiter.update(matrixBuffer, true);
+        doNotOptimize(limiter.limit(1.0));
+    });
+    runner.run("PowerLimiter/update (6 dirty rows)", 6 * CUBE_SIZE * sizeof(Color), [&]() {
+        limiter.update(matrixBuffer, false);
+        doNotOptimize(limiter.limit(1.0));
+    });
+    
+    // Scan-order buffer: the full encode reads pixels sequentially
+    scanOrderBuffer.markAllDirty();
+    runner.run("MatrixDriver/encodeFrame (full, scan order)", frameBytes + planeBytes, [&]() {
+        sequence += 2;
+        driver.encodeFrame(scanOrderBuffer, sequence);
+    });
+    
+    // Same with rotated and mirrored faces: the mapper's LUT keeps it a gather
+    PixelMapper rotated;
+    for (int face = 0; face < CUBE_DEPTH; ++face) {
+        rotated.setOrientation(face, FaceOrientation{(face % 4) * 90, face >= 4, false});
+    }
+    driver.setPixelMapper(rotated);
+    matrixBuffer.markAllDirty();
+    runner.run("MatrixDriver/encodeFrame (full, rotated faces)", frameBytes + planeBytes, [&]() {
+        sequence += 2;
+        driver.encodeFrame(matrixBuffer, sequence);
+    });
+    matrixBuffer.resetDirty();
+
+    // Full scan-out into simulated HUB75 chains; the reconstructed image
+    // checks the encoder and scan-out end to end
+    for (int chainCount : {1, ChainLayout::MAX_CHAINS}) {
+        std::string name = "MatrixDriver/renderFrame (simulated panel";
+        name += chainCount == 1 ? ")" : ", " + std::to_string(chainCount) + " chains)";
+        if (!runner.matches(name)) {
+            continue;
+        }
+        
+        ChainLayout layout = ChainLayout::interleaved(chainCount);
+        auto simulator = std::make_unique<PanelSimulator>(20, layout);
+        PanelSimulator* panel = simulator.get();
+        MatrixDriver simulatedDriver{std::move(simulator)};
+        if (!simulatedDriver.setChainLayout(layout) || !simulatedDriver.initialize()) {
+            continue;
+        }
+        
+        MatrixBuffer gradient;
+        for (int face = 0; face < CUBE_DEPTH; ++face) {
+            for (int y = 0; y < CUBE_SIZE; ++y) {
+                for (int x = 0; x < CUBE_SIZE; ++x) {
+                    gradient.setLED(Position(x, y, face), Color(x * 4, y * 4, face * 42));
+                }
+            }
+        }
+        simulatedDriver.encodeFrame(gradient, 1);
+        simulatedDriver.renderFrame();
+        panel->resetStatistics();
+
+        runner.run(name, simulatedDriver.getEncoder().getPlaneBytes(), [&]() {
+            simulatedDriver.renderFrame();
+        });
+
+        // Reconstruction error against the encoded intensity levels
+        const BitplaneEncoder& encoder = simulatedDriver.getEncoder();
+        const ColorLUT& colors = encoder.getColorLUT();
+        double maxLevel = (1 << encoder.getBitDepth()) - 1;
+        std::vector<Color> image = panel->getImage();
+        int maxError = 0;
+        for (int i = 0; i < TOTAL_LEDS; ++i) {
+            const Color& source = gradient.getBuffer()[i];
+            int face = i / (CUBE_SIZE * CUBE_SIZE);
+            int expected[3] = {
+                static_cast<int>(std::lround(colors.getLevel(face, 0, source.r) * 255.0 / maxLevel)),
+                static_cast<int>(std::lround(colors.getLevel(face, 1, source.g) * 255.0 / maxLevel)),
+                static_cast<int>(std::lround(colors.getLevel(face, 2, source.b) * 255.0 / maxLevel)),
+            };
+            maxError = std::max({maxError, std::abs(image[i].r - expected[0]),
+                                 std::abs(image[i].g - expected[1]), std::abs(image[i].b - expected[2])});
+        }
+
+        PanelStatistics statistics = panel->getStatistics();
+        std::cout << "Simulated panel (" << panel->getWriteTime() << " ns/write, "
+                  << encoder.getBitDepth() << "-bit BCM, " << chainCount << " chain(s)): "
+                  << std::setprecision(1) << statistics.refreshRate << " Hz refresh, "
+                  << std::setprecision(2) << statistics.effectiveBitDepth << " effective bits, "
+                  << (statistics.outputDuty * 100.0) << "% lit, max reconstruction error "
+                  << maxError << "/255" << std::endl;
+        simulatedDriver.shutdown();
+    }
+
+    // GPIO pin writes through the register backend on a plain memory block
+    const int GPIO_WRITES = 1024;
+    GPIOController gpio(std::make_unique<MappedGPIOBackend>());
+    gpio.initialize();
+    runner.run("GPIOController/writeBits (1024 writes)", GPIO_WRITES * 8, [&]() {
+        for (int i = 0; i < GPIO_WRITES; ++i) {
+            gpio.writeBits(static_cast<uint32_t>(i) << GPIOPins::R1_PIN, ChainLayout::PINS[0].mask());
+        }
+    });
+    runner.run("GPIOController/setPin (1024 writes)", GPIO_WRITES * 4, [&]() {
+        for (int i = 0; i < GPIO_WRITES; ++i) {
+            gpio.setPin(GPIOPins::CLOCK_PIN, i & 1);
+        }
+    });
+    runner.run("GPIOController/spiWriteByte (1024 bytes)", GPIO_WRITES * 8 * 8, [&]() {
+        for (int i = 0; i < GPIO_WRITES; ++i) {
+            gpio.spiWriteByte(static_cast<uint8_t>(i));
+        }
+    });
+
+    // Instrumentation overhead per probe
+    runner.run("FrameProfiler/scoped timer", 0, [&]() {
+        ScopedStageTimer timer(FrameStage::Update);
+    });
+    FrameProfiler::setEnabled(false);
+    runner.run("FrameProfiler/scoped timer (disabled)", 0, [&]() {
+        ScopedStageTimer timer(FrameStage::Update);
+    });
+    FrameProfiler::setEnabled(true);
+
+    // Machine-readable output
+    if (!jsonPath.empty()) {
+        std::string json = runner.toJSON();
+        if (jsonPath == "-") {
+            std::ostream stdoutStream(stdoutBuffer);
+            stdoutStream << json << std::flush;
+        } else {
+            std::ofstream output(jsonPath);
+            if (!output.is_open()) {
+                std::cerr << "Failed to open JSON output file: " << jsonPath << std::endl;
+                return -1;
+            }
+            output << json;
+            std::cout << "Results written to: " << jsonPath << std::endl;
+        }
+    }
+
+    return 0;
+}
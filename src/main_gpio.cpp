@@ -1,9 +1,15 @@
 #include "core/LEDCube.h"
 #include "core/AnimationManager.h"
+#include "core/FrameProfiler.h"
+#include "core/JobSystem.h"
+#include "core/FramePipeline.h"
+#include "core/FramePacer.h"
 #include "gpio/MatrixDriver.h"
 #include <iostream>
 #include <chrono>
-#include <thread>
+#include <string>
+#include <cstdlib>
+#include <stdexcept>
 #include <signal.h>
 
 using namespace LEDCube;
@@ -21,30 +27,107 @@ void signalHandler(int signal) {
     }
 }
 
-int main() {
+int main(int argc, char** argv) {
     std::cout << "LED Cube Matrix - GPIO Mode" << std::endl;
     std::cout << "===========================" << std::endl;
     
+    // Command line options for the display thread
+    RealtimeOptions displayOptions;
+    int chainCount = 1;
+    std::string mappingPath;
+    double gamma = ColorSettings().gamma;
+    PowerBudget powerBudget;
+    FramePipelineOptions pipelineOptions;
+    FramePacerOptions pacerOptions;
+    ScanGovernorOptions governorOptions;
+    governorOptions.enabled = true;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--realtime" && i + 1 < argc) {
+            displayOptions.priority = std::atoi(argv[++i]);
+        } else if (arg == "--cpu" && i + 1 < argc) {
+            displayOptions.cpu = std::atoi(argv[++i]);
+        } else if (arg == "--lock-memory") {
+            displayOptions.lockMemory = true;
+        } else if (arg == "--chains" && i + 1 < argc) {
+            chainCount = std::atoi(argv[++i]);
+        } else if (arg == "--mapping" && i + 1 < argc) {
+            mappingPath = argv[++i];
+        } else if (arg == "--gamma" && i + 1 < argc) {
+            gamma = std::atof(argv[++i]);
+        } else if (arg == "--max-amps" && i + 1 < argc) {
+            powerBudget.maxAmps = std::atof(argv[++i]);
+        } else if (arg == "--pipeline-depth" && i + 1 < argc) {
+            pipelineOptions.depth = std::atoi(argv[++i]);
+        } else if (arg == "--fps" && i + 1 < argc) {
+            // 0 hands frames over as fast as they are produced
+            pacerOptions.targetRate = std::atof(argv[++i]);
+        } else if (arg == "--min-refresh" && i + 1 < argc) {
+            // 0 keeps the fixed 60 Hz, 11-bit settings
+            governorOptions.minRefreshRate = std::atoi(argv[++i]);
+            governorOptions.enabled = governorOptions.minRefreshRate > 0;
+        }
+    }
+    
+    if (pacerOptions.targetRate > 0.0) {
+        pipelineOptions.frameRate = pacerOptions.targetRate;
+    }
+    
+    // Worker threads for rendering and conversion stay off the display core
+    JobSystemOptions jobOptions;
+    if (displayOptions.cpu >= 0) {
+        jobOptions.excludedCpus.push_back(displayOptions.cpu);
+    }
+    JobSystem::configureShared(jobOptions);
+    std::cout << "Job system: " << JobSystem::shared().getWorkerCount() << " workers on "
+              << JobSystem::shared().getCpus().size() << " cores" << std::endl;
+    
     // Set up signal handlers for clean shutdown
     signal(SIGINT, signalHandler);
     signal(SIGTERM, signalHandler);
     
+    // Drive the real GPIO registers when available, else simulate them
+    std::unique_ptr<GPIOBackend> gpioBackend;
+    try {
+        gpioBackend = std::make_unique<MappedGPIOBackend>("/dev/gpiomem");
+    } catch (const std::exception& e) {
+        std::cerr << "GPIO registers unavailable (" << e.what() << "), using simulated GPIO" << std::endl;
+    }
+    
     // Initialize matrix driver
-    MatrixDriver matrixDriver;
+    MatrixDriver matrixDriver(std::move(gpioBackend));
     g_matrixDriver = &matrixDriver;
     
+    // Panel mapping from a file, or faces dealt over parallel chains; a
+    // bad setting is reported and ignored
+    try {
+        if (!mappingPath.empty()) {
+            matrixDriver.setPixelMapper(PixelMapper::loadFromFile(mappingPath));
+        } else {
+            matrixDriver.setChainLayout(ChainLayout::interleaved(chainCount));
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Ignoring panel mapping: " << e.what() << std::endl;
+    }
+    
     if (!matrixDriver.initialize()) {
         std::cerr << "Failed to initialize matrix driver!" << std::endl;
         return -1;
     }
     
-    // Initialize LED cube and animation manager
-    LEDCube cube;
+    // Initialize animation manager
     AnimationManager animationManager;
     
     // Set up matrix driver
     matrixDriver.setRefreshRate(60);
-    matrixDriver.setBrightness(0.8);
+    ColorSettings colorSettings;
+    colorSettings.gamma = gamma;
+    colorSettings.brightness = 0.8;
+    matrixDriver.setColorSettings(colorSettings);
+    matrixDriver.setPowerBudget(powerBudget);
+    matrixDriver.setDisplayThreadOptions(displayOptions);
+    matrixDriver.setScanGovernorOptions(governorOptions);
+    matrixDriver.setBufferLayout(BufferLayout::ScanOrder);
     
     // Get available animations
     auto animations = animationManager.getAnimationNames();
@@ -60,47 +143,114 @@ int main() {
         std::cout << "Playing: " << animations[0] << std::endl;
     }
     
+    // Animations update and render on the pipeline's thread, ahead of the
+    // frame being handed to the display
+    FramePipeline pipeline([&](LEDCube::LEDCube& frame, double deltaTime) {
+        {
+            ScopedStageTimer timer(FrameStage::Update);
+            animationManager.update(deltaTime);
+        }
+        {
+            ScopedStageTimer timer(FrameStage::Render);
+            animationManager.render(frame);
+        }
+    }, pipelineOptions);
+    
     // Start display thread
     matrixDriver.startDisplay();
+    pipeline.start();
     
     // Main update loop
-    auto lastTime = std::chrono::high_resolution_clock::now();
     int currentAnimationIndex = 0;
     auto lastAnimationChange = std::chrono::high_resolution_clock::now();
+    auto lastProfileReport = lastAnimationChange;
+    FrameProfiler::setThreadName("main");
     
     std::cout << "Running on hardware. Press Ctrl+C to exit." << std::endl;
     std::cout << "Animations will cycle automatically every 10 seconds." << std::endl;
     
+    // Unpaced, wait on the pipeline for the next frame rather than spin
+    FramePacer pacer(pacerOptions);
+    auto frameTimeout = pacerOptions.targetRate > 0.0 ? std::chrono::milliseconds(0) : std::chrono::milliseconds(100);
     while (!shouldExit) {
         auto currentTime = std::chrono::high_resolution_clock::now();
-        auto deltaTime = std::chrono::duration<double>(currentTime - lastTime).count();
-        lastTime = currentTime;
-        
-        // Cap delta time to prevent large jumps
-        if (deltaTime > 0.1) deltaTime = 0.1;
         
-        // Update animation
-        animationManager.update(deltaTime);
-        
-        // Update matrix buffer
-        matrixDriver.updateBuffer(MatrixBuffer(cube.getBuffer()));
+        // Encode the next finished frame here and hand its bit planes to the
+        // display thread; if none is ready the display keeps the last one
+        if (const LEDCube::LEDCube* frame = pipeline.acquireFrame(frameTimeout)) {
+            {
+                ScopedStageTimer timer(FrameStage::Present);
+                matrixDriver.acquireBackBuffer().copyFrom(*frame);
+            }
+            matrixDriver.presentBackBuffer(); // Timed as the convert stage
+            pipeline.releaseFrame();
+            pacer.framePresented();
+        }
         
         // Cycle through animations every 10 seconds
         auto timeSinceChange = std::chrono::duration<double>(currentTime - lastAnimationChange).count();
         if (timeSinceChange > 10.0 && !animations.empty()) {
             currentAnimationIndex = (currentAnimationIndex + 1) % animations.size();
-            animationManager.playAnimation(animations[currentAnimationIndex]);
+            std::string name = animations[currentAnimationIndex];
+            pipeline.post([&animationManager, name]() { animationManager.playAnimation(name); });
             std::cout << "Switched to: " << animations[currentAnimationIndex] << std::endl;
             lastAnimationChange = currentTime;
+            
+            FrameHandoffStats stats = matrixDriver.getFrameStats();
+            std::cout << "Frames produced: " << stats.framesProduced
+                      << ", displayed: " << stats.framesDisplayed
+                      << ", dropped: " << stats.framesDropped << std::endl;
+            FramePipelineStats pipelineStats = pipeline.getStats();
+            std::cout << "Pipeline depth " << pipelineOptions.depth << ": input-to-display latency p50="
+                      << pipelineStats.latencyP50Ms << " ms  p99=" << pipelineStats.latencyP99Ms
+                      << " ms  max=" << pipelineStats.latencyMaxMs << " ms, produce "
+                      << pipelineStats.produceAvgMs << " ms/frame, stalls " << pipelineStats.stalls << std::endl;
+            FramePacerStats pacerStats = pacer.getStats();
+            std::cout << "Frame pacing: " << pacerStats.achievedRate << " FPS";
+            if (pacerOptions.targetRate > 0.0) {
+                std::cout << " of " << pacerOptions.targetRate << ", missed " << pacerStats.missedDeadlines
+                          << "/" << pacerStats.deadlines << " deadlines, skipped " << pacerStats.skippedFrames
+                          << " frames, wake-up p99=" << pacerStats.wakeP99Us << " us";
+            } else {
+                std::cout << " (unpaced)";
+            }
+            std::cout << std::endl;
         }
         
-        // Small delay to prevent excessive CPU usage
-        std::this_thread::sleep_for(std::chrono::milliseconds(16)); // ~60 FPS
+        // Dump frame timing every 5 seconds
+        if (FrameProfiler::isEnabled() &&
+            std::chrono::duration<double>(currentTime - lastProfileReport).count() >= 5.0) {
+            FrameProfiler::report(std::cout);
+            JitterStats jitter = matrixDriver.getScanJitter();
+            std::cout << "Row scan jitter: p50=" << jitter.p50Us << " us  p99=" << jitter.p99Us
+                      << " us  max=" << jitter.maxUs << " us  overruns=" << jitter.overruns
+                      << "/" << jitter.count << std::endl;
+            ScanOperatingPoint point = matrixDriver.getOperatingPoint();
+            if (point.bitDepth > 0) {
+                std::cout << "Scan: " << point.bitDepth << " bits at " << point.refreshRate << " Hz, capacity "
+                          << static_cast<int>(point.capacity) << " Hz, shift " << static_cast<int>(point.shiftNsPerPlane)
+                          << " ns/plane, load " << static_cast<int>(point.load * 100) << "%, retunes "
+                          << point.retunes << std::endl;
+            }
+            if (powerBudget.maxAmps > 0.0) {
+                PowerStats power = matrixDriver.getPowerStats();
+                std::cout << "Power: " << power.outputAmps << " A of " << powerBudget.maxAmps << " A budget ("
+                          << power.requestedAmps << " A requested, brightness x" << power.scale << ")" << std::endl;
+            }
+            lastProfileReport = currentTime;
+        }
+        
+        // Wait for the next frame's deadline
+        {
+            ScopedStageTimer timer(FrameStage::Sleep);
+            pacer.waitForNextFrame();
+        }
     }
     
     std::cout << "Shutting down..." << std::endl;
     
     // Clean shutdown
+    pipeline.stop();
     matrixDriver.stopDisplay();
     matrixDriver.shutdown();
     g_matrixDriver = nullptr;
@@ -0,0 +1,166 @@
+#include "core/LEDCube.h"
+#include "core/AnimationManager.h"
+#include "core/FrameProfiler.h"
+#include "core/FramePacer.h"
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <string>
+#include <cstdlib>
+#include <signal.h>
+
+using namespace LEDCube;
+
+// Global variables for signal handling
+volatile bool shouldExit = false;
+
+void signalHandler(int signal) {
+    std::cout << "\nReceived signal " << signal << ", shutting down..." << std::endl;
+    shouldExit = true;
+}
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [OPTIONS]" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --animation NAME  Animation to run (default: first available)" << std::endl;
+    std::cout << "  --frames N        Number of frames to produce, 0 = until Ctrl+C (default: 600)" << std::endl;
+    std::cout << "  --fps RATE        Target frame rate, 0 = as fast as possible (default: 0)" << std::endl;
+    std::cout << "  --output FILE     Append raw RGB888 frames to FILE (default: discard)" << std::endl;
+    std::cout << "  --no-profile      Disable per-stage frame timing" << std::endl;
+    std::cout << "  --list            List available animations and exit" << std::endl;
+    std::cout << "  --help, -h        Show this help message" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    std::string animationName;
+    std::string outputPath;
+    long frameLimit = 600;
+    double targetFps = 0.0;
+    bool listOnly = false;
+
+    // Parse command line arguments
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--animation" && i + 1 < argc) {
+            animationName = argv[++i];
+        } else if (arg == "--frames" && i + 1 < argc) {
+            frameLimit = std::atol(argv[++i]);
+        } else if (arg == "--fps" && i + 1 < argc) {
+            targetFps = std::atof(argv[++i]);
+        } else if (arg == "--output" && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else if (arg == "--no-profile") {
+            FrameProfiler::setEnabled(false);
+        } else if (arg == "--list") {
+            listOnly = true;
+        } else if (arg == "--help" || arg == "-h") {
+            printUsage(argv[0]);
+            return 0;
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            printUsage(argv[0]);
+            return -1;
+        }
+    }
+
+    std::cout << "LED Cube Matrix - Headless Mode" << std::endl;
+    std::cout << "===============================" << std::endl;
+
+    // Set up signal handlers for clean shutdown
+    signal(SIGINT, signalHandler);
+    signal(SIGTERM, signalHandler);
+
+    // Initialize LED cube and animation manager
+    LEDCube::LEDCube cube;
+    AnimationManager animationManager;
+
+    auto animations = animationManager.getAnimationNames();
+    if (listOnly) {
+        for (const auto& name : animations) {
+            std::cout << name << std::endl;
+        }
+        return 0;
+    }
+
+    if (animationName.empty() && !animations.empty()) {
+        animationName = animations[0];
+    }
+    if (!animationManager.getAnimation(animationName)) {
+        std::cerr << "Animation '" << animationName << "' not found!" << std::endl;
+        return -1;
+    }
+    animationManager.playAnimation(animationName);
+    std::cout << "Playing: " << animationName << std::endl;
+
+    // Frame sink: raw RGB888 file or nothing
+    std::ofstream output;
+    if (!outputPath.empty()) {
+        output.open(outputPath, std::ios::binary | std::ios::app);
+        if (!output.is_open()) {
+            std::cerr << "Failed to open output file: " << outputPath << std::endl;
+            return -1;
+        }
+        std::cout << "Writing frames to: " << outputPath << std::endl;
+    }
+
+    // Animations advance by a fixed step so runs are reproducible;
+    // unpaced runs simulate 60 FPS time
+    double deltaTime = 1.0 / (targetFps > 0.0 ? targetFps : 60.0);
+    FramePacerOptions pacerOptions;
+    pacerOptions.targetRate = targetFps;
+
+    auto startTime = std::chrono::steady_clock::now();
+    FramePacer pacer(pacerOptions);
+    long frameCount = 0;
+    FrameProfiler::setThreadName("main");
+
+    while (!shouldExit && (frameLimit == 0 || frameCount < frameLimit)) {
+        // Update and render animation
+        {
+            ScopedStageTimer timer(FrameStage::Update);
+            animationManager.update(deltaTime);
+        }
+        {
+            ScopedStageTimer timer(FrameStage::Render);
+            animationManager.render(cube);
+        }
+
+        // Hand the frame to the sink
+        if (output.is_open()) {
+            ScopedStageTimer timer(FrameStage::Present);
+            const auto& pixels = cube.getBuffer();
+            output.write(reinterpret_cast<const char*>(pixels.data()), pixels.size() * sizeof(Color));
+        }
+        cube.resetDirty();
+        pacer.framePresented();
+        ++frameCount;
+
+        // Pace to the target rate, if any; every frame is still produced,
+        // late ones just start without waiting
+        if (targetFps > 0.0) {
+            ScopedStageTimer timer(FrameStage::Sleep);
+            pacer.waitForNextFrame();
+        }
+    }
+
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    std::cout << "Frames: " << frameCount << std::endl;
+    std::cout << "Elapsed: " << elapsed << " s" << std::endl;
+    if (frameCount > 0 && elapsed > 0.0) {
+        std::cout << "Average: " << (elapsed * 1000.0 / frameCount) << " ms/frame ("
+                  << (frameCount / elapsed) << " FPS)" << std::endl;
+    }
+    if (targetFps > 0.0) {
+        FramePacerStats pacerStats = pacer.getStats();
+        std::cout << "Frame pacing: missed " << pacerStats.missedDeadlines << "/" << pacerStats.deadlines
+                  << " deadlines, skipped " << pacerStats.skippedFrames << " frame slots, wake-up p99="
+                  << pacerStats.wakeP99Us << " us  max=" << pacerStats.wakeMaxUs << " us" << std::endl;
+    }
+    if (FrameProfiler::isEnabled()) {
+        FrameProfiler::report(std::cout);
+    }
+
+    return 0;
+}
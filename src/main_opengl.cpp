@@ -1,27 +1,84 @@
 #include "core/LEDCube.h"
 #include "core/AnimationManager.h"
+#include "core/FrameProfiler.h"
+#include "core/FramePipeline.h"
+#include "core/FramePacer.h"
 #include "opengl/OpenGLRenderer.h"
 #include <iostream>
 #include <chrono>
-#include <thread>
+#include <string>
+#include <cstdlib>
+#include <algorithm>
 
 using namespace LEDCube;
 
-int main() {
+int main(int argc, char** argv) {
     std::cout << "LED Cube Matrix - OpenGL Preview Mode" << std::endl;
     std::cout << "=====================================" << std::endl;
     
+    // Command line options
+    bool offscreen = false;
+    long frameLimit = 0; // 0 = run until the window closes
+    FramePipelineOptions pipelineOptions;
+    FramePacerOptions pacerOptions;
+    bool vsync = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--offscreen") {
+            offscreen = true;
+        } else if (arg == "--frames" && i + 1 < argc) {
+            frameLimit = std::atol(argv[++i]);
+        } else if (arg == "--pipeline-depth" && i + 1 < argc) {
+            pipelineOptions.depth = std::atoi(argv[++i]);
+        } else if (arg == "--fps" && i + 1 < argc) {
+            pacerOptions.targetRate = std::atof(argv[++i]);
+        } else if (arg == "--vsync") {
+            vsync = true;
+        } else if (arg == "--no-profile") {
+            FrameProfiler::setEnabled(false);
+        }
+    }
+    
+    // Either the pacer or the buffer swap sets the frame rate, never both
+    if (pacerOptions.targetRate > 0.0) {
+        pipelineOptions.frameRate = pacerOptions.targetRate;
+    }
+    if (vsync) {
+        pacerOptions.targetRate = 0.0;
+    }
+    
     // Initialize OpenGL renderer
     OpenGLRenderer renderer;
+    renderer.setOffscreen(offscreen);
+    renderer.setVSync(vsync);
     if (!renderer.initialize(1024, 768, "LED Cube Preview")) {
         std::cerr << "Failed to initialize OpenGL renderer!" << std::endl;
         return -1;
     }
     
-    // Initialize LED cube and animation manager
-    LEDCube::LEDCube cube;
+    // With vsync, frames come at the monitor's refresh rate
+    int refreshRate = vsync ? renderer.getRefreshRate() : 0;
+    if (refreshRate > 0) {
+        pipelineOptions.frameRate = refreshRate;
+        std::cout << "Vsync at " << refreshRate << " Hz" << std::endl;
+    }
+    
+    // Initialize animation manager
     AnimationManager animationManager;
     
+    // Animations update and render on the pipeline's thread, ahead of the
+    // frame being drawn; everything else that touches them is posted to it
+    FramePipeline pipeline([&](LEDCube::LEDCube& frame, double deltaTime) {
+        {
+            ScopedStageTimer timer(FrameStage::Update);
+            animationManager.update(deltaTime);
+        }
+        {
+            ScopedStageTimer timer(FrameStage::Render);
+            animationManager.render(frame);
+        }
+    }, pipelineOptions);
+    
     // Set up renderer
     renderer.setBackgroundColor(0.1f, 0.1f, 0.1f);
     renderer.setCubeScale(1.0f);
@@ -30,10 +87,12 @@ int main() {
     // Set up rotation callback for rain animation
     renderer.setCubeRotationCallback([&](float pitch, float yaw) {
         // Update rain animation gravity direction
-        auto currentAnimation = animationManager.getCurrentAnimation();
-        if (auto rainAnim = std::dynamic_pointer_cast<RainAnimation>(currentAnimation)) {
-            rainAnim->setGravityDirection(pitch, yaw);
-        }
+        pipeline.post([&animationManager, pitch, yaw]() {
+            auto currentAnimation = animationManager.getCurrentAnimation();
+            if (auto rainAnim = std::dynamic_pointer_cast<RainAnimation>(currentAnimation)) {
+                rainAnim->setGravityDirection(pitch, yaw);
+            }
+        });
     });
     
     // Set up input callbacks
@@ -45,29 +104,29 @@ int main() {
                     break;
                 case GLFW_KEY_1:
                     std::cout << "Playing Rain Animation" << std::endl;
-                    animationManager.playAnimation("Rain");
+                    pipeline.post([&animationManager]() { animationManager.playAnimation("Rain"); });
                     break;
                 case GLFW_KEY_2:
                     std::cout << "Playing Wave Animation" << std::endl;
-                    animationManager.playAnimation("Wave");
+                    pipeline.post([&animationManager]() { animationManager.playAnimation("Wave"); });
                     break;
                 case GLFW_KEY_3:
                     std::cout << "Playing Cube Rotation Animation" << std::endl;
-                    animationManager.playAnimation("Cube Rotation");
+                    pipeline.post([&animationManager]() { animationManager.playAnimation("Cube Rotation"); });
                     break;
                 case GLFW_KEY_4:
                     std::cout << "Playing Test Pattern Animation" << std::endl;
                     break;
                 case GLFW_KEY_5:
                     std::cout << "Playing Game of Life Animation" << std::endl;
-                    animationManager.playAnimation("Game of Life");
+                    pipeline.post([&animationManager]() { animationManager.playAnimation("Game of Life"); });
                     break;
                 case GLFW_KEY_SPACE:
                     std::cout << "Pause/Resume Animation" << std::endl;
                     break;
                 case GLFW_KEY_R:
                     std::cout << "Reset Animation" << std::endl;
-                    animationManager.resetCurrentAnimation();
+                    pipeline.post([&animationManager]() { animationManager.resetCurrentAnimation(); });
                     break;
             }
         }
@@ -96,35 +155,83 @@ int main() {
     }
     
     // Main render loop
-    auto lastTime = std::chrono::high_resolution_clock::now();
+    auto lastReport = std::chrono::high_resolution_clock::now();
+    long frameCount = 0;
+    double uploadTimeTotal = 0.0;
+    double uploadTimeMax = 0.0;
+    long uploadSamples = 0;
+    FrameProfiler::setThreadName("main");
     
-    while (!renderer.shouldClose()) {
+    pipeline.start();
+    // Unpaced (vsync), wait on the pipeline for the next frame rather than
+    // spin without swapping
+    FramePacer pacer(pacerOptions);
+    auto frameTimeout = pacerOptions.targetRate > 0.0 ? std::chrono::milliseconds(0) : std::chrono::milliseconds(100);
+    while (!renderer.shouldClose() && (frameLimit == 0 || frameCount < frameLimit)) {
         auto currentTime = std::chrono::high_resolution_clock::now();
-        auto deltaTime = std::chrono::duration<double>(currentTime - lastTime).count();
-        lastTime = currentTime;
-        
-        // Cap delta time to prevent large jumps
-        if (deltaTime > 0.1) deltaTime = 0.1;
         
-        // Update animation
-        animationManager.update(deltaTime);
+        // Draw the next finished frame (texture upload is timed inside
+        // renderCube); if none is ready the last one stays on screen
+        if (const LEDCube::LEDCube* frame = pipeline.acquireFrame(frameTimeout)) {
+            renderer.beginFrame();
+            renderer.renderCube(*frame);
+            {
+                ScopedStageTimer timer(FrameStage::Present);
+                renderer.endFrame();
+            }
+            pipeline.releaseFrame();
+            pacer.framePresented();
+            ++frameCount;
+            
+            uploadTimeTotal += renderer.getLastUploadTimeMs();
+            uploadTimeMax = std::max(uploadTimeMax, renderer.getLastUploadTimeMs());
+            ++uploadSamples;
+        }
         
-        // **This line fills the cube buffer with the animation**
-        animationManager.render(cube);
-
-        // Render frame
-        renderer.beginFrame();
-        renderer.renderCube(cube);
-        renderer.endFrame();
+        // Report texture upload cost every few seconds
+        if (std::chrono::duration<double>(currentTime - lastReport).count() >= 5.0) {
+            std::cout << "Texture upload: " << (uploadSamples > 0 ? uploadTimeTotal / uploadSamples : 0.0) << " ms avg, "
+                      << uploadTimeMax << " ms max per frame" << std::endl;
+            uploadTimeTotal = 0.0;
+            uploadTimeMax = 0.0;
+            uploadSamples = 0;
+            lastReport = currentTime;
+            FramePipelineStats pipelineStats = pipeline.getStats();
+            std::cout << "Pipeline depth " << pipelineOptions.depth << ": input-to-display latency p50="
+                      << pipelineStats.latencyP50Ms << " ms  p99=" << pipelineStats.latencyP99Ms
+                      << " ms  max=" << pipelineStats.latencyMaxMs << " ms, produce "
+                      << pipelineStats.produceAvgMs << " ms/frame, stalls " << pipelineStats.stalls << std::endl;
+            FramePacerStats pacerStats = pacer.getStats();
+            std::cout << "Frame pacing: " << pacerStats.achievedRate << " FPS";
+            if (pacerOptions.targetRate > 0.0) {
+                std::cout << " of " << pacerOptions.targetRate << ", missed " << pacerStats.missedDeadlines
+                          << "/" << pacerStats.deadlines << " deadlines, skipped " << pacerStats.skippedFrames
+                          << " frames, wake-up p99=" << pacerStats.wakeP99Us << " us";
+            } else {
+                std::cout << " (vsync";
+                if (refreshRate > 0) {
+                    std::cout << " at " << refreshRate << " Hz";
+                }
+                std::cout << ")";
+            }
+            std::cout << std::endl;
+            if (FrameProfiler::isEnabled()) {
+                FrameProfiler::report(std::cout);
+            }
+        }
         
         // Poll events
         renderer.pollEvents();
         
-        // Small delay to prevent excessive CPU usage
-        std::this_thread::sleep_for(std::chrono::milliseconds(16)); // ~60 FPS
+        // Wait for the next frame's deadline
+        {
+            ScopedStageTimer timer(FrameStage::Sleep);
+            pacer.waitForNextFrame();
+        }
     }
     
     std::cout << "Shutting down..." << std::endl;
+    pipeline.stop();
     renderer.shutdown();
     
     return 0;
@@ -1,6 +1,9 @@
 #include "opengl/CubeRenderer.h"
+#include "core/FrameProfiler.h"
 #include <iostream>
 #include <vector>
+#include <chrono>
+#include <cstring>
 #include <GL/glew.h>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -12,24 +15,25 @@ static const char* vertexShaderSource = R"(
 #version 330 core
 layout(location = 0) in vec3 aPos;
 layout(location = 1) in vec2 aTexCoord;
+layout(location = 2) in float aFace;
 
 uniform mat4 uViewProj;
 uniform mat4 uModel;
 
-out vec2 TexCoord;
+out vec3 TexCoord;
 
 void main() {
     gl_Position = uViewProj * uModel * vec4(aPos, 1.0);
-    TexCoord = aTexCoord;
+    TexCoord = vec3(aTexCoord, aFace);
 }
 )";
 
 static const char* fragmentShaderSource = R"(
 #version 330 core
-in vec2 TexCoord;
+in vec3 TexCoord;
 out vec4 FragColor;
 
-uniform sampler2D uTexture;
+uniform sampler2DArray uTexture;
 
 void main() {
     FragColor = texture(uTexture, TexCoord);
@@ -37,10 +41,13 @@ void main() {
 )";
 
 CubeRenderer::CubeRenderer()
-    : cubeVAO(0), cubeVBO(0), cubeEBO(0), cubeShader(0), initialized(false), cubeScale(1.0f) {
-    // Initialize texture IDs for 6 faces
-    for (int i = 0; i < 6; ++i) {
-        faceTextures[i] = 0;
+    : cubeVAO(0), cubeVBO(0), cubeEBO(0), viewProjLocation(-1), modelLocation(-1), faceTextureArray(0),
+      uploadIndex(0), persistentMapping(false), lastUploadTimeMs(0.0),
+      initialized(false), cubeScale(1.0f) {
+    for (int i = 0; i < UPLOAD_BUFFER_COUNT; ++i) {
+        uploadBuffers[i] = 0;
+        mappedUploads[i] = nullptr;
+        uploadFences[i] = nullptr;
     }
 }
 
@@ -51,60 +58,56 @@ CubeRenderer::~CubeRenderer() {
 bool CubeRenderer::initialize() {
     if (initialized) return true;
     
-    // Compile shaders
-    GLuint vert = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vert, 1, &vertexShaderSource, nullptr);
-    glCompileShader(vert);
-    
-    GLuint frag = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(frag, 1, &fragmentShaderSource, nullptr);
-    glCompileShader(frag);
-    
-    cubeShader = glCreateProgram();
-    glAttachShader(cubeShader, vert);
-    glAttachShader(cubeShader, frag);
-    glLinkProgram(cubeShader);
+    // Compile shaders and resolve uniform locations once
+    if (!cubeShader.loadFromStrings(vertexShaderSource, fragmentShaderSource)) {
+        std::cerr << "Cube Renderer: Failed to build cube shader" << std::endl;
+        return false;
+    }
+    viewProjLocation = cubeShader.getUniformLocation("uViewProj");
+    modelLocation = cubeShader.getUniformLocation("uModel");
     
-    glDeleteShader(vert);
-    glDeleteShader(frag);
+    // The sampler always reads texture unit 0
+    cubeShader.use();
+    cubeShader.setInt(cubeShader.getUniformLocation("uTexture"), 0);
     
     // Create cube geometry (6 faces, each with 2 triangles)
+    // Layout: position (3), texture coordinate (2), face / texture layer (1)
     float vertices[] = {
         // Front face
-        -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-         0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
-         0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
-        -0.5f,  0.5f,  0.5f,  0.0f, 1.0f,
+        -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,  0.0f,
+         0.5f, -0.5f,  0.5f,  1.0f, 0.0f,  0.0f,
+         0.5f,  0.5f,  0.5f,  1.0f, 1.0f,  0.0f,
+        -0.5f,  0.5f,  0.5f,  0.0f, 1.0f,  0.0f,
         
         // Back face
-        -0.5f, -0.5f, -0.5f,  1.0f, 0.0f,
-         0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
-         0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
-        -0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+        -0.5f, -0.5f, -0.5f,  1.0f, 0.0f,  1.0f,
+         0.5f, -0.5f, -0.5f,  0.0f, 0.0f,  1.0f,
+         0.5f,  0.5f, -0.5f,  0.0f, 1.0f,  1.0f,
+        -0.5f,  0.5f, -0.5f,  1.0f, 1.0f,  1.0f,
         
         // Left face
-        -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-        -0.5f,  0.5f, -0.5f,  0.0f, 0.0f,
-        -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-        -0.5f, -0.5f,  0.5f,  1.0f, 1.0f,
+        -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,  2.0f,
+        -0.5f,  0.5f, -0.5f,  0.0f, 0.0f,  2.0f,
+        -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,  2.0f,
+        -0.5f, -0.5f,  0.5f,  1.0f, 1.0f,  2.0f,
         
         // Right face
-         0.5f,  0.5f,  0.5f,  0.0f, 0.0f,
-         0.5f,  0.5f, -0.5f,  1.0f, 0.0f,
-         0.5f, -0.5f, -0.5f,  1.0f, 1.0f,
-         0.5f, -0.5f,  0.5f,  0.0f, 1.0f,
+         0.5f,  0.5f,  0.5f,  0.0f, 0.0f,  3.0f,
+         0.5f,  0.5f, -0.5f,  1.0f, 0.0f,  3.0f,
+         0.5f, -0.5f, -0.5f,  1.0f, 1.0f,  3.0f,
+         0.5f, -0.5f,  0.5f,  0.0f, 1.0f,  3.0f,
         
         // Top face
-        -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
-         0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-         0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-        -0.5f,  0.5f,  0.5f,  0.0f, 0.0f,
+        -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,  4.0f,
+         0.5f,  0.5f, -0.5f,  1.0f, 1.0f,  4.0f,
+         0.5f,  0.5f,  0.5f,  1.0f, 0.0f,  4.0f,
+        -0.5f,  0.5f,  0.5f,  0.0f, 0.0f,  4.0f,
         
         // Bottom face
-        -0.5f, -0.5f, -0.5f,  1.0f, 1.0f,
-         0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-         0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-        -0.5f, -0.5f,  0.5f,  1.0f, 0.0f
+        -0.5f, -0.5f, -0.5f,  1.0f, 1.0f,  5.0f,
+         0.5f, -0.5f, -0.5f,  0.0f, 1.0f,  5.0f,
+         0.5f, -0.5f,  0.5f,  0.0f, 0.0f,  5.0f,
+        -0.5f, -0.5f,  0.5f,  1.0f, 0.0f,  5.0f
     };
     
     unsigned int indices[] = {
@@ -127,29 +130,35 @@ bool CubeRenderer::initialize() {
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cubeEBO);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
     
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
     glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(5 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+    
+    // Create one texture array with a layer per face
+    glGenTextures(1, &faceTextureArray);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, faceTextureArray);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     
-    // Create textures for each face
+    // Initialize with test pattern
+    std::vector<uint8_t> testData(FRAME_BYTES, 0);
     for (int i = 0; i < 6; ++i) {
-        glGenTextures(1, &faceTextures[i]);
-        glBindTexture(GL_TEXTURE_2D, faceTextures[i]);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-        
-        // Initialize with test pattern
-        std::vector<uint8_t> testData(64 * 64 * 3, 0);
         for (int j = 0; j < 64 * 64; ++j) {
-            testData[j * 3 + 0] = (i * 40) % 255;  // R
-            testData[j * 3 + 1] = (i * 60) % 255;  // G
-            testData[j * 3 + 2] = (i * 80) % 255;  // B
+            int idx = (i * 64 * 64 + j) * 3;
+            testData[idx + 0] = (i * 40) % 255;  // R
+            testData[idx + 1] = (i * 60) % 255;  // G
+            testData[idx + 2] = (i * 80) % 255;  // B
         }
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 64, 64, 0, GL_RGB, GL_UNSIGNED_BYTE, testData.data());
     }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGB8, 64, 64, 6, 0, GL_RGB, GL_UNSIGNED_BYTE, testData.data());
+    
+    createUploadBuffers();
     
     initialized = true;
     return true;
@@ -161,11 +170,22 @@ void CubeRenderer::shutdown() {
     glDeleteVertexArrays(1, &cubeVAO);
     glDeleteBuffers(1, &cubeVBO);
     glDeleteBuffers(1, &cubeEBO);
-    glDeleteProgram(cubeShader);
+    cubeShader.destroy();
+    glDeleteTextures(1, &faceTextureArray);
     
-    for (int i = 0; i < 6; ++i) {
-        glDeleteTextures(1, &faceTextures[i]);
+    for (int i = 0; i < UPLOAD_BUFFER_COUNT; ++i) {
+        if (uploadFences[i]) {
+            glDeleteSync(uploadFences[i]);
+            uploadFences[i] = nullptr;
+        }
+        if (mappedUploads[i]) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, uploadBuffers[i]);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            mappedUploads[i] = nullptr;
+        }
     }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glDeleteBuffers(UPLOAD_BUFFER_COUNT, uploadBuffers);
     
     initialized = false;
 }
@@ -176,57 +196,136 @@ void CubeRenderer::renderCube(const LEDCube& cube, const glm::mat4& viewProj, co
     // Update textures from cube data
     updateTextures(cube);
     
-    glUseProgram(cubeShader);
+    cubeShader.use();
+    cubeShader.setMat4(viewProjLocation, viewProj);
+    cubeShader.setMat4(modelLocation, model);
+    
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, faceTextureArray);
     glBindVertexArray(cubeVAO);
     
-    // Set view-projection matrix
-    glUniformMatrix4fv(glGetUniformLocation(cubeShader, "uViewProj"), 1, GL_FALSE, glm::value_ptr(viewProj));
+    // All six faces in one call; each vertex carries its face's texture layer
+    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, (void*)0);
     
-    // Draw each face with its texture
-    for (int face = 0; face < 6; ++face) {
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, faceTextures[face]);
-        glUniform1i(glGetUniformLocation(cubeShader, "uTexture"), 0);
-        
-        // Set model matrix for this face (now passed in as parameter)
-        glUniformMatrix4fv(glGetUniformLocation(cubeShader, "uModel"), 1, GL_FALSE, glm::value_ptr(model));
+    glBindVertexArray(0);
+}
+
+void CubeRenderer::createUploadBuffers() {
+    glGenBuffers(UPLOAD_BUFFER_COUNT, uploadBuffers);
+    
+    // Persistent coherent mapping (GL 4.4 / ARB_buffer_storage) lets the CPU
+    // write straight into driver memory; otherwise fall back to mapping with
+    // buffer invalidation every frame
+    persistentMapping = GLEW_ARB_buffer_storage;
+    
+    for (int i = 0; i < UPLOAD_BUFFER_COUNT; ++i) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, uploadBuffers[i]);
         
-        // Draw this face (4 vertices per face, 6 faces total)
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)(face * 6 * sizeof(unsigned int)));
+        if (persistentMapping) {
+            GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(GL_PIXEL_UNPACK_BUFFER, FRAME_BYTES, nullptr, flags);
+            mappedUploads[i] = static_cast<uint8_t*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, FRAME_BYTES, flags));
+        } else {
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, FRAME_BYTES, nullptr, GL_STREAM_DRAW);
+        }
     }
     
-    glBindVertexArray(0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    
+    std::cout << "Cube Renderer: Texture uploads use "
+              << (persistentMapping ? "persistently mapped" : "re-mapped")
+              << " pixel buffers" << std::endl;
 }
 
 void CubeRenderer::updateTextures(const LEDCube& cube) {
-    // Map the 2D panel data to 6 cube faces
-    // Each face is 64x64, so we extract 64x64 sections from the panel
+    // The cube buffer is face-major with 64 contiguous rows of packed RGB per
+    // face, which is exactly the texture array layout. Dirty rows are copied
+    // at the same offset into the staging buffer and uploaded from there in
+    // runs of consecutive rows; clean rows keep last frame's texture data.
+    static_assert(sizeof(Color) == 3, "Color must be tightly packed RGB");
+    
+    if (!cube.isDirty()) {
+        lastUploadTimeMs = 0.0;
+        return;
+    }
+    
+    ScopedStageTimer timer(FrameStage::Upload);
+    auto startTime = std::chrono::steady_clock::now();
+    
+    const uint8_t* pixels = reinterpret_cast<const uint8_t*>(cube.getBuffer().data());
+    const DirtyMasks& dirty = cube.getDirtyMasks();
+    const GLsizeiptr rowBytes = 64 * 3;
+    const GLsizeiptr faceBytes = 64 * rowBytes;
     
+    int index = uploadIndex;
+    uploadIndex = (uploadIndex + 1) % UPLOAD_BUFFER_COUNT;
+    
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, uploadBuffers[index]);
+    
+    uint8_t* staging;
+    if (persistentMapping) {
+        // Wait until the GPU has finished reading this buffer's previous upload
+        if (uploadFences[index]) {
+            glClientWaitSync(uploadFences[index], GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+            glDeleteSync(uploadFences[index]);
+            uploadFences[index] = nullptr;
+        }
+        staging = mappedUploads[index];
+    } else {
+        staging = static_cast<uint8_t*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, FRAME_BYTES,
+                                                         GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+        if (!staging) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            return;
+        }
+    }
+    
+    // Stage every dirty run with a single memcpy
     for (int face = 0; face < 6; ++face) {
-        std::vector<uint8_t> faceData(64 * 64 * 3);
-        
-        // Extract this face's data from the panel
-        for (int y = 0; y < 64; ++y) {
-            for (int x = 0; x < 64; ++x) {
-                // Map panel coordinates to cube face
-                int panelX = x + face * 64;  // Each face is 64 pixels wide
-                int panelY = y;
-                
-                // Get color from cube data
-                Position pos(x, y, face);
-                Color color = cube.getLED(pos);
-                
-                int idx = (y * 64 + x) * 3;
-                faceData[idx + 0] = color.r;
-                faceData[idx + 1] = color.g;
-                faceData[idx + 2] = color.b;
-            }
+        uint64_t rows = dirty[face];
+        while (rows != 0) {
+            int firstRow = __builtin_ctzll(rows);
+            uint64_t run = ~(rows >> firstRow);
+            int rowCount = run == 0 ? 64 - firstRow : __builtin_ctzll(run);
+            
+            GLsizeiptr offset = face * faceBytes + firstRow * rowBytes;
+            std::memcpy(staging + offset, pixels + offset, rowCount * rowBytes);
+            
+            rows &= (firstRow + rowCount >= 64) ? 0 : (~uint64_t(0) << (firstRow + rowCount));
         }
-        
-        // Update texture
-        glBindTexture(GL_TEXTURE_2D, faceTextures[face]);
-        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 64, 64, GL_RGB, GL_UNSIGNED_BYTE, faceData.data());
     }
+    
+    if (!persistentMapping) {
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    }
+    
+    // Upload the same runs from the pixel buffer, asynchronously to the CPU
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, faceTextureArray);
+    
+    for (int face = 0; face < 6; ++face) {
+        uint64_t rows = dirty[face];
+        while (rows != 0) {
+            int firstRow = __builtin_ctzll(rows);
+            uint64_t run = ~(rows >> firstRow);
+            int rowCount = run == 0 ? 64 - firstRow : __builtin_ctzll(run);
+            
+            GLsizeiptr offset = face * faceBytes + firstRow * rowBytes;
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, firstRow, face, 64, rowCount, 1,
+                            GL_RGB, GL_UNSIGNED_BYTE, reinterpret_cast<const void*>(offset));
+            
+            rows &= (firstRow + rowCount >= 64) ? 0 : (~uint64_t(0) << (firstRow + rowCount));
+        }
+    }
+    
+    if (persistentMapping) {
+        uploadFences[index] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+    
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    
+    auto endTime = std::chrono::steady_clock::now();
+    lastUploadTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
 }
 
 void CubeRenderer::setCubeScale(float scale) { cubeScale = scale; }
@@ -204,6 +204,15 @@ void OpenGLRenderer::setVSync(bool enabled) {
     }
 }
 
+int OpenGLRenderer::getRefreshRate() const {
+    GLFWmonitor* monitor = window ? glfwGetWindowMonitor(window) : nullptr;
+    if (!monitor) {
+        monitor = glfwGetPrimaryMonitor();
+    }
+    const GLFWvidmode* mode = monitor ? glfwGetVideoMode(monitor) : nullptr;
+    return mode ? mode->refreshRate : 0;
+}
+
 bool OpenGLRenderer::initializeGLFW() {
     if (!glfwInit()) {
         std::cerr << "OpenGL Renderer: Failed to initialize GLFW" << std::endl;
@@ -213,6 +222,7 @@ bool OpenGLRenderer::initializeGLFW() {
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, offscreen ? GLFW_FALSE : GLFW_TRUE);
     
     window = glfwCreateWindow(windowWidth, windowHeight, windowTitle.c_str(), nullptr, nullptr);
     if (!window) {
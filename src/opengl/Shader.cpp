@@ -2,6 +2,9 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <vector>
+#include <algorithm>
+#include <glm/gtc/type_ptr.hpp>
 
 namespace LEDCube {
 
@@ -41,96 +44,156 @@ bool Shader::loadFromFiles(const std::string& vertexPath, const std::string& fra
 }
 
 bool Shader::loadFromStrings(const std::string& vertexSource, const std::string& fragmentSource) {
-    // In a real implementation, this would compile and link the shaders
-    // For now, we'll just simulate the shader creation
+    destroy();
+    
+    GLuint vertexShader = 0;
+    GLuint fragmentShader = 0;
+    
+    if (!compileShader(vertexShader, GL_VERTEX_SHADER, vertexSource)) {
+        return false;
+    }
+    
+    if (!compileShader(fragmentShader, GL_FRAGMENT_SHADER, fragmentSource)) {
+        glDeleteShader(vertexShader);
+        return false;
+    }
+    
+    programID = glCreateProgram();
+    glAttachShader(programID, vertexShader);
+    glAttachShader(programID, fragmentShader);
     
-    std::cout << "Shader: Loading shaders from strings" << std::endl;
+    bool linked = linkProgram();
     
-    // Simulate shader compilation
-    programID = 1; // Dummy program ID
+    glDetachShader(programID, vertexShader);
+    glDetachShader(programID, fragmentShader);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+    
+    if (!linked) {
+        destroy();
+        return false;
+    }
     
-    std::cout << "Shader: Shaders loaded successfully" << std::endl;
     return true;
 }
 
 void Shader::use() {
     if (programID != 0) {
-        // In real implementation: glUseProgram(programID);
-        std::cout << "Shader: Using program " << programID << std::endl;
+        glUseProgram(programID);
     }
 }
 
 void Shader::destroy() {
     if (programID != 0) {
-        // In real implementation: glDeleteProgram(programID);
+        glDeleteProgram(programID);
         programID = 0;
-        std::cout << "Shader: Program destroyed" << std::endl;
     }
+    uniformLocations.clear();
 }
 
 void Shader::setBool(const std::string& name, bool value) {
-    // In real implementation: glUniform1i(glGetUniformLocation(programID, name.c_str()), (int)value);
-    std::cout << "Shader: Set bool uniform '" << name << "' = " << value << std::endl;
+    glUniform1i(getUniformLocation(name), static_cast<int>(value));
 }
 
 void Shader::setInt(const std::string& name, int value) {
-    // In real implementation: glUniform1i(glGetUniformLocation(programID, name.c_str()), value);
-    std::cout << "Shader: Set int uniform '" << name << "' = " << value << std::endl;
+    glUniform1i(getUniformLocation(name), value);
 }
 
 void Shader::setFloat(const std::string& name, float value) {
-    // In real implementation: glUniform1f(glGetUniformLocation(programID, name.c_str()), value);
-    std::cout << "Shader: Set float uniform '" << name << "' = " << value << std::endl;
+    glUniform1f(getUniformLocation(name), value);
 }
 
 void Shader::setVec2(const std::string& name, const glm::vec2& value) {
-    // In real implementation: glUniform2fv(glGetUniformLocation(programID, name.c_str()), 1, &value[0]);
-    std::cout << "Shader: Set vec2 uniform '" << name << "' = (" << value.x << ", " << value.y << ")" << std::endl;
+    glUniform2fv(getUniformLocation(name), 1, glm::value_ptr(value));
 }
 
 void Shader::setVec3(const std::string& name, const glm::vec3& value) {
-    // In real implementation: glUniform3fv(glGetUniformLocation(programID, name.c_str()), 1, &value[0]);
-    std::cout << "Shader: Set vec3 uniform '" << name << "' = (" << value.x << ", " << value.y << ", " << value.z << ")" << std::endl;
+    glUniform3fv(getUniformLocation(name), 1, glm::value_ptr(value));
 }
 
 void Shader::setVec4(const std::string& name, const glm::vec4& value) {
-    // In real implementation: glUniform4fv(glGetUniformLocation(programID, name.c_str()), 1, &value[0]);
-    std::cout << "Shader: Set vec4 uniform '" << name << "' = (" << value.x << ", " << value.y << ", " << value.z << ", " << value.w << ")" << std::endl;
+    glUniform4fv(getUniformLocation(name), 1, glm::value_ptr(value));
 }
 
 void Shader::setMat3(const std::string& name, const glm::mat3& value) {
-    // In real implementation: glUniformMatrix3fv(glGetUniformLocation(programID, name.c_str()), 1, GL_FALSE, &value[0][0]);
-    std::cout << "Shader: Set mat3 uniform '" << name << "'" << std::endl;
+    glUniformMatrix3fv(getUniformLocation(name), 1, GL_FALSE, glm::value_ptr(value));
 }
 
 void Shader::setMat4(const std::string& name, const glm::mat4& value) {
-    // In real implementation: glUniformMatrix4fv(glGetUniformLocation(programID, name.c_str()), 1, GL_FALSE, &value[0][0]);
-    std::cout << "Shader: Set mat4 uniform '" << name << "'" << std::endl;
+    glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, glm::value_ptr(value));
 }
 
-bool Shader::compileShader(GLuint& shaderID, GLenum type, const std::string& source) {
-    // In real implementation, this would compile the shader
-    // For now, we'll just simulate the compilation
+void Shader::setInt(GLint location, int value) {
+    glUniform1i(location, value);
+}
+
+void Shader::setFloat(GLint location, float value) {
+    glUniform1f(location, value);
+}
+
+void Shader::setMat4(GLint location, const glm::mat4& value) {
+    glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
+}
+
+GLint Shader::getUniformLocation(const std::string& name) {
+    auto it = uniformLocations.find(name);
+    if (it != uniformLocations.end()) {
+        return it->second;
+    }
     
-    shaderID = 1; // Dummy shader ID
-    return true;
+    GLint location = glGetUniformLocation(programID, name.c_str());
+    if (location < 0) {
+        std::cerr << "Shader: Uniform '" << name << "' not found" << std::endl;
+    }
+    uniformLocations[name] = location;
+    return location;
 }
 
-bool Shader::linkProgram() {
-    // In real implementation, this would link the shader program
-    // For now, we'll just simulate the linking
+bool Shader::compileShader(GLuint& shaderID, GLenum type, const std::string& source) {
+    const char* sourcePtr = source.c_str();
     
+    shaderID = glCreateShader(type);
+    glShaderSource(shaderID, 1, &sourcePtr, nullptr);
+    glCompileShader(shaderID);
+    
+    if (!checkCompileErrors(shaderID, type == GL_VERTEX_SHADER ? "VERTEX" : "FRAGMENT")) {
+        glDeleteShader(shaderID);
+        shaderID = 0;
+        return false;
+    }
     return true;
 }
 
-void Shader::checkCompileErrors(GLuint shader, const std::string& type) {
-    // In real implementation, this would check for shader compilation errors
-    // For now, we'll just simulate the error checking
+bool Shader::linkProgram() {
+    glLinkProgram(programID);
+    return checkCompileErrors(programID, "PROGRAM");
 }
 
-GLint Shader::getUniformLocation(const std::string& name) {
-    // In real implementation: return glGetUniformLocation(programID, name.c_str());
-    return 0; // Dummy location
+bool Shader::checkCompileErrors(GLuint shader, const std::string& type) {
+    GLint success = 0;
+    GLint logLength = 0;
+    
+    if (type == "PROGRAM") {
+        glGetProgramiv(shader, GL_LINK_STATUS, &success);
+        glGetProgramiv(shader, GL_INFO_LOG_LENGTH, &logLength);
+    } else {
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
+    }
+    
+    if (success) {
+        return true;
+    }
+    
+    std::vector<char> log(std::max(logLength, 1), '\0');
+    if (type == "PROGRAM") {
+        glGetProgramInfoLog(shader, log.size(), nullptr, log.data());
+        std::cerr << "Shader: Program link error: " << log.data() << std::endl;
+    } else {
+        glGetShaderInfoLog(shader, log.size(), nullptr, log.data());
+        std::cerr << "Shader: " << type << " shader compile error: " << log.data() << std::endl;
+    }
+    return false;
 }
 
-} // namespace LEDCube 
\ No newline at end of file
+} // namespace LEDCube